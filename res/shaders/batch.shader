@@ -0,0 +1,37 @@
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+
+out vec2 v_TexCoord;
+
+layout(std140) uniform Camera
+{
+    mat4 u_View;
+    mat4 u_Projection;
+    mat4 u_ViewProj;
+    vec4 u_CameraPosition;
+};
+
+void main()
+{
+    gl_Position = u_ViewProj * position;
+    v_TexCoord = texCoord;
+}
+
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_TexCoord;
+
+uniform sampler2D u_Texture;
+
+void main()
+{
+    vec4 texColor = texture(u_Texture, v_TexCoord);
+    color = texColor;
+}
@@ -2,11 +2,24 @@
 #include <GLFW/glfw3.h>
 
 #include <iostream>
+#include <cstdlib>
 #include <fstream>
 #include <string>
 #include <sstream>
 
 #include "Renderer.h"
+#include "AssetArchive.h"
+#include "AssetBaker.h"
+#include "TextureManager.h"
+#include "GPUProfiler.h"
+#include "GPUMemory.h"
+#include "GPUDeletionQueue.h"
+#include "Profiler.h"
+#include "FrameClock.h"
+#include "WorkerThread.h"
+#include "JobSystem.h"
+#include "FrameArena.h"
+#include "MemoryTracker.h"
 
 #include "imgui/imgui.h"
 #include "imgui/imgui_impl_glfw.h"
@@ -15,16 +28,71 @@
 #include "tests/TestClearColor.h"
 #include "tests/TestTexture2D.h"
 #include "tests/TestBatchRendering.h"
+#include "tests/TestImageDecoding.h"
+#include "tests/TestJobSystem.h"
+#include "tests/TestCommandBuffers.h"
+#include "tests/TestResourcePool.h"
+#include "tests/TestBatchTransform.h"
+#include "tests/TestSpatialIndex.h"
+#include "tests/BenchmarkRunner.h"
 
 
-int main(void)
+int main(int argc, char** argv)
 {
     GLFWwindow* window;
 
+    //Packs a resource directory into an archive for the post build step
+    if (argc >= 4 && std::string(argv[1]) == "--pack")
+    {
+        return AssetArchive::Build(argv[2], argv[3]) ? 0 : 1;
+    }
+
+    //Baking needs a GL context to validate shaders and compress
+    //textures, so it runs with a hidden window and exits afterwards
+    bool bake = argc >= 4 && std::string(argv[1]) == "--bake";
+
+    //Runs a single test for a number of frames and writes the timings,
+    //--egl creates the context through EGL for headless CI machines
+    //--benchmark <test name> [--frames N] [--warmup N] [--out results.json] [--egl]
+    bool benchmark = false;
+    bool useEGL = false;
+    test::BenchmarkOptions benchmarkOptions;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--benchmark" && i + 1 < argc)
+        {
+            benchmark = true;
+            benchmarkOptions.TestName = argv[++i];
+        }
+        else if (arg == "--frames" && i + 1 < argc)
+            benchmarkOptions.Frames = std::atoi(argv[++i]);
+        else if (arg == "--warmup" && i + 1 < argc)
+            benchmarkOptions.WarmupFrames = std::atoi(argv[++i]);
+        else if (arg == "--out" && i + 1 < argc)
+            benchmarkOptions.OutputPath = argv[++i];
+        else if (arg == "--egl")
+            useEGL = true;
+    }
+    int exitCode = 0;
+
+    //Resources are read from the packed archive when one has been built
+    //and straight from res/ otherwise
+    AssetArchive::Get().Mount("res.pak");
+
     /* Initialize the library */
     if (!glfwInit())
         return -1;
 
+    if (bake || benchmark)
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    if (useEGL)
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+
+#if defined(GL_DEBUG_CALLBACK) || defined(GL_DEBUG_CALLBACK_ASYNC)
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
+#endif
 
     /* Create a windowed mode window and its OpenGL context */
     window = glfwCreateWindow(640, 480, "Learning OpenGL", NULL, NULL);
@@ -37,8 +105,8 @@ int main(void)
     /* Make the window's context current */
     glfwMakeContextCurrent(window);
 
-    //Sets framerate to Vsync
-    glfwSwapInterval(1);
+    //Sets framerate to Vsync, benchmarks run unpaced
+    glfwSwapInterval(benchmark ? 0 : 1);
 
     if (glewInit() != GLEW_OK) {
         std::cout << "Error" << std::endl;
@@ -46,6 +114,20 @@ int main(void)
 
     std::cout << glGetString(GL_VERSION) << std::endl;
 
+#if defined(GL_DEBUG_CALLBACK)
+    EnableGLDebugOutput(true);
+#elif defined(GL_DEBUG_CALLBACK_ASYNC)
+    EnableGLDebugOutput(false);
+#endif
+
+    if (bake)
+    {
+        bool compress = argc >= 5 && std::string(argv[4]) == "--compress";
+        bool baked = AssetBaker::Bake(argv[2], argv[3], compress);
+        glfwTerminate();
+        return baked ? 0 : 1;
+    }
+
     //Scopes the draw call so there is no infinite loop from the index 
     //buffer not being destroyed before glfw is terminated causing the 
     //error checker to loop infinetly because it doesn't have a valid context
@@ -56,9 +138,22 @@ int main(void)
 
 
         Renderer renderer;
-
-        //Initializes the ImGui library
+        GPUProfiler::Get().Init();
+        Profiler::Get().SetThreadName("Main");
+        JobSystem::Get().Init();
+        FrameClock clock;
+        bool vsync = true;
+
+        //Tests that opt in update the next frame on this thread while the
+        //main thread, the only one with the GL context, renders the current
+        WorkerThread updateThread("Update");
+        bool threadedUpdate = true;
+
+        //Initializes the ImGui library, with its memory tracked as UI
         IMGUI_CHECKVERSION();
+        ImGui::SetAllocatorFunctions(
+            [](size_t size, void*) { MEMORY_TAG(UI); return MemoryTracker::Allocate(size); },
+            [](void* pointer, void*) { MemoryTracker::Free(pointer); });
         ImGui::CreateContext();
         ImGuiIO& io = ImGui::GetIO(); (void)io;
         ImGui::StyleColorsDark();
@@ -72,10 +167,33 @@ int main(void)
         testMenu->RegisterTest<test::TestClearColor>("Clear Color");
         testMenu->RegisterTest<test::TestTexture2D>("2D Texture");
         testMenu->RegisterTest<test::TestBatchRendering>("Batch Rendering");
+        testMenu->RegisterTest<test::TestImageDecoding>("Image Decoding");
+        testMenu->RegisterTest<test::TestJobSystem>("Job System");
+        testMenu->RegisterTest<test::TestCommandBuffers>("Command Buffers");
+        testMenu->RegisterTest<test::TestResourcePool>("Resource Pool");
+        testMenu->RegisterTest<test::TestBatchTransform>("Batch Transforms");
+        testMenu->RegisterTest<test::TestSpatialIndex>("Spatial Index");
+
+        if (benchmark)
+        {
+            exitCode = test::BenchmarkRunner::Run(window, *testMenu, benchmarkOptions) ? 0 : 1;
+        }
 
-        while (!glfwWindowShouldClose(window))
+        while (!benchmark && !glfwWindowShouldClose(window))
         {
-            renderer.Clear();
+            clock.Tick();
+            FrameArena::NewFrame();
+            MemoryTracker::NewFrame();
+
+            PROFILE_SCOPE("Frame");
+            GPUProfiler::Get().BeginFrame();
+            TextureManager::Get().NewFrame();
+            JobSystem::Get().ProcessMainThreadJobs();
+
+            {
+                GPU_PROFILE_SCOPE("Clear");
+                renderer.Clear();
+            }
 
             ImGui_ImplOpenGL3_NewFrame();
             ImGui_ImplGlfw_NewFrame();
@@ -83,9 +201,39 @@ int main(void)
 
             if (currentTest)
             {
-                currentTest->OnUpdate(0.0f);
-                currentTest->OnRender();
+                auto update = [&clock, currentTest]() {
+                    {
+                        PROFILE_SCOPE("OnFixedUpdate");
+                        while (clock.StepFixed())
+                        {
+                            currentTest->OnFixedUpdate(clock.GetFixedTimestep());
+                        }
+                    }
+                    PROFILE_SCOPE("OnUpdate");
+                    currentTest->OnUpdate(clock.GetDeltaTime());
+                };
+
+                if (threadedUpdate && currentTest->IsThreaded())
+                {
+                    updateThread.Kick(update);
+                    {
+                        PROFILE_SCOPE("OnRender");
+                        GPU_PROFILE_SCOPE("Test");
+                        currentTest->OnRender();
+                    }
+                    updateThread.Wait();
+                    currentTest->OnPublish();
+                }
+                else
+                {
+                    update();
+                    currentTest->OnPublish();
+                    PROFILE_SCOPE("OnRender");
+                    GPU_PROFILE_SCOPE("Test");
+                    currentTest->OnRender();
+                }
 
+                PROFILE_SCOPE("OnImGuiRender");
                 ImGui::Begin("Test");
 
                 if (currentTest != testMenu && ImGui::Button("<-"))
@@ -96,15 +244,174 @@ int main(void)
 
                 currentTest->OnImGuiRender();
 
+                if (ImGui::CollapsingHeader("Renderer Stats", ImGuiTreeNodeFlags_DefaultOpen))
+                {
+                    const RendererStats& stats = Renderer::GetLastFrameStats();
+                    ImGui::Text("Draw calls %u, triangles %u", stats.DrawCalls, stats.Triangles);
+                    ImGui::Text("Binds: shader %u, texture %u, vertex array %u", stats.ShaderBinds, stats.TextureBinds, stats.VertexArrayBinds);
+                    ImGui::Text("Uniform uploads %u, uploaded %.1f KB", stats.UniformUploads, stats.BytesUploaded / 1024.0f);
+                    ImGui::Text("Heap allocations %llu, frame arena %.1f KB", (unsigned long long)MemoryTracker::GetLastFrameAllocations(), FrameArena::GetTotalUsed() / 1024.0f);
+                    if (ImGui::Button("Dump stats"))
+                    {
+                        std::ofstream stream("renderer_stats.json");
+                        stats.WriteJSON(stream);
+                        stream << std::endl;
+                    }
+                }
+
+                if (ImGui::CollapsingHeader("Frame Pacing"))
+                {
+                    if (ImGui::Checkbox("Vsync", &vsync))
+                    {
+                        glfwSwapInterval(vsync ? 1 : 0);
+                    }
+                    ImGui::Checkbox("Threaded update", &threadedUpdate);
+                    clock.OnImGuiRender();
+                }
+
+                if (ImGui::CollapsingHeader("Memory"))
+                {
+                    MemoryTagStats total = MemoryTracker::GetTotalStats();
+                    ImGui::Text("Heap %.2f MB (peak %.2f MB), %llu allocations last frame", total.CurrentBytes / (1024.0f * 1024.0f),
+                        total.PeakBytes / (1024.0f * 1024.0f), (unsigned long long)total.LastFrameAllocations);
+
+                    ImGui::Columns(5);
+                    ImGui::Text("Tag"); ImGui::NextColumn();
+                    ImGui::Text("Current KB"); ImGui::NextColumn();
+                    ImGui::Text("Peak KB"); ImGui::NextColumn();
+                    ImGui::Text("Live blocks"); ImGui::NextColumn();
+                    ImGui::Text("Allocs / frame"); ImGui::NextColumn();
+                    for (int i = 0; i < (int)MemoryTag::Count; i++)
+                    {
+                        MemoryTagStats stats = MemoryTracker::GetStats((MemoryTag)i);
+                        ImGui::Text("%s", MemoryTracker::GetTagName((MemoryTag)i)); ImGui::NextColumn();
+                        ImGui::Text("%.1f", stats.CurrentBytes / 1024.0f); ImGui::NextColumn();
+                        ImGui::Text("%.1f", stats.PeakBytes / 1024.0f); ImGui::NextColumn();
+                        ImGui::Text("%llu", (unsigned long long)(stats.Allocations - stats.Frees)); ImGui::NextColumn();
+                        ImGui::Text("%llu", (unsigned long long)stats.LastFrameAllocations); ImGui::NextColumn();
+                    }
+                    ImGui::Columns(1);
+
+                    if (ImGui::Button("Write report"))
+                    {
+                        std::ofstream stream("memory_report.json");
+                        MemoryTracker::WriteJSON(stream);
+                        stream << std::endl;
+                    }
+                }
+
+                if (ImGui::CollapsingHeader("Textures"))
+                {
+                    TextureStats stats = TextureManager::Get().GetStats();
+                    int budgetMB = (int)(stats.BudgetBytes / (1024 * 1024));
+                    if (ImGui::SliderInt("Budget (MB)", &budgetMB, 1, 2048))
+                    {
+                        TextureManager::Get().SetBudget((size_t)budgetMB * 1024 * 1024);
+                    }
+                    ImGui::Text("Resident %u / %u textures", stats.ResidentCount, stats.TextureCount);
+                    ImGui::Text("Memory %.2f MB (peak %.2f MB)", stats.ResidentBytes / (1024.0f * 1024.0f), stats.PeakResidentBytes / (1024.0f * 1024.0f));
+                    ImGui::Text("Evictions %u, restores %u, mip drops %u", stats.Evictions, stats.Restores, stats.MipDrops);
+                }
+
+                if (ImGui::CollapsingHeader("GPU Memory"))
+                {
+                    GPUMemory& gpuMemory = GPUMemory::Get();
+                    ImGui::Text("Tracked %.2f MB in %u objects (peak %.2f MB)", gpuMemory.GetTotalBytes() / (1024.0f * 1024.0f),
+                        (unsigned int)gpuMemory.GetAllocationCount(), gpuMemory.GetPeakBytes() / (1024.0f * 1024.0f));
+                    for (int i = 0; i < (int)GPUMemoryCategory::Count; i++)
+                    {
+                        ImGui::BulletText("%s %.2f MB", GPUMemory::GetCategoryName((GPUMemoryCategory)i), gpuMemory.GetCategoryBytes((GPUMemoryCategory)i) / (1024.0f * 1024.0f));
+                    }
+
+                    DriverMemoryInfo info;
+                    if (GPUMemory::QueryDriverMemory(info))
+                        ImGui::Text("Driver (%s): %d MB available of %d MB", info.Source, info.CurrentAvailableKB / 1024, info.TotalAvailableKB / 1024);
+                    else
+                        ImGui::Text("Driver doesn't report memory usage");
+
+                    GPUDeletionQueue& deletionQueue = GPUDeletionQueue::Get();
+                    bool deferred = deletionQueue.IsDeferred();
+                    if (ImGui::Checkbox("Deferred deletion", &deferred))
+                        deletionQueue.SetDeferred(deferred);
+                    ImGui::SameLine();
+                    ImGui::Text("%u queued, %u deleted", (unsigned int)deletionQueue.GetQueuedCount(), (unsigned int)deletionQueue.GetDeletedCount());
+
+                    if (ImGui::TreeNode("Objects"))
+                    {
+                        ImGui::Columns(4);
+                        ImGui::Text("Category"); ImGui::NextColumn();
+                        ImGui::Text("ID"); ImGui::NextColumn();
+                        ImGui::Text("KB"); ImGui::NextColumn();
+                        ImGui::Text("Site"); ImGui::NextColumn();
+                        for (const GPUAllocation& allocation : gpuMemory.GetAllocations())
+                        {
+                            ImGui::Text("%s", GPUMemory::GetCategoryName(allocation.Category)); ImGui::NextColumn();
+                            ImGui::Text("%u", allocation.RendererID); ImGui::NextColumn();
+                            ImGui::Text("%.1f", allocation.Bytes / 1024.0f); ImGui::NextColumn();
+                            ImGui::Text("%s", allocation.Site.c_str()); ImGui::NextColumn();
+                        }
+                        ImGui::Columns(1);
+                        ImGui::TreePop();
+                    }
+
+                    if (ImGui::Button("Dump"))
+                    {
+                        gpuMemory.Dump("gpu_memory.json");
+                    }
+                }
+
+                if (ImGui::CollapsingHeader("GPU Timings"))
+                {
+                    ImGui::Columns(5);
+                    ImGui::Text("Scope"); ImGui::NextColumn();
+                    ImGui::Text("Last ms"); ImGui::NextColumn();
+                    ImGui::Text("Min ms"); ImGui::NextColumn();
+                    ImGui::Text("Avg ms"); ImGui::NextColumn();
+                    ImGui::Text("P99 ms"); ImGui::NextColumn();
+                    for (const GPUTimingStats& stats : GPUProfiler::Get().GetStats())
+                    {
+                        ImGui::Text("%s", stats.Name.c_str()); ImGui::NextColumn();
+                        ImGui::Text("%.3f", stats.LastMs); ImGui::NextColumn();
+                        ImGui::Text("%.3f", stats.MinMs); ImGui::NextColumn();
+                        ImGui::Text("%.3f", stats.AvgMs); ImGui::NextColumn();
+                        ImGui::Text("%.3f", stats.P99Ms); ImGui::NextColumn();
+                    }
+                    ImGui::Columns(1);
+                    ImGui::Text("Frames not ready in time: %u", GPUProfiler::Get().GetDroppedFrames());
+                }
+
+                if (ImGui::CollapsingHeader("CPU Profiler"))
+                {
+                    if (ImGui::Button("Write trace"))
+                    {
+                        Profiler::Get().WriteChromeTrace("profile.json");
+                    }
+                    ImGui::SameLine();
+                    ImGui::Text("Open profile.json in ui.perfetto.dev or chrome://tracing");
+                }
+
                 ImGui::End();
             }
 
-            ImGui::Render();
-            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+            {
+                PROFILE_SCOPE("ImGui");
+                GPU_PROFILE_SCOPE("ImGui");
+                ImGui::Render();
+                ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+            }
+            GPUProfiler::Get().EndFrame();
+            GPUDeletionQueue::Get().EndFrame();
+            Renderer::EndFrame();
 
-            GLCall(glfwSwapBuffers(window));
+            {
+                PROFILE_SCOPE("SwapBuffers");
+                GLCall(glfwSwapBuffers(window));
+            }
 
-            GLCall(glfwPollEvents());
+            {
+                PROFILE_SCOPE("PollEvents");
+                GLCall(glfwPollEvents());
+            }
         }
         
         //Cleans up memory at end of the loop
@@ -113,6 +420,11 @@ int main(void)
         {
             delete testMenu;
         }
+
+        GPUMemory::Get().ReportLeaks();
+        JobSystem::Get().Shutdown();
+        GPUProfiler::Get().Shutdown();
+        GPUDeletionQueue::Get().Flush();
     }
 
 
@@ -122,5 +434,5 @@ int main(void)
     ImGui::DestroyContext();
 
     glfwTerminate();
-    return 0;
+    return exitCode;
 }
\ No newline at end of file
@@ -0,0 +1,258 @@
+#include "AssetArchive.h"
+#include "Hash.h"
+#include "MemoryTracker.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+static const char s_ArchiveMagic[4] = { 'L', 'G', 'P', 'K' };
+
+static uint64_t AlignOffset(uint64_t offset)
+{
+	return (offset + AssetArchive::ArchiveAlignment - 1) & ~(AssetArchive::ArchiveAlignment - 1);
+}
+
+AssetData::AssetData()
+	: m_Data(nullptr), m_Size(0)
+{
+}
+
+AssetArchive::AssetArchive()
+	: m_Header(nullptr), m_Entries(nullptr), m_Names(nullptr)
+{
+}
+
+AssetArchive& AssetArchive::Get()
+{
+	static AssetArchive instance;
+	return instance;
+}
+
+std::string AssetArchive::NormalizePath(const std::string& path)
+{
+	//Resources are referenced with whatever case the code happened to use,
+	//which only works on disk because Windows paths are case insensitive
+	std::string normalized = path;
+	for (char& c : normalized)
+		c = c == '\\' ? '/' : (char)tolower((unsigned char)c);
+
+	while (normalized.compare(0, 2, "./") == 0)
+		normalized.erase(0, 2);
+	return normalized;
+}
+
+bool AssetArchive::Mount(const std::string& path)
+{
+	MEMORY_TAG(Assets);
+	Unmount();
+
+	std::unique_ptr<MappedFile> file = std::make_unique<MappedFile>(path);
+	if (!file->IsOpen() || file->GetSize() < sizeof(ArchiveHeader))
+		return false;
+
+	const ArchiveHeader* header = (const ArchiveHeader*)file->GetData();
+	uint64_t tableSize = sizeof(ArchiveHeader) + (uint64_t)header->entryCount * sizeof(ArchiveEntry) + header->namesSize;
+	if (memcmp(header->magic, s_ArchiveMagic, sizeof(s_ArchiveMagic)) != 0 || header->version != ArchiveVersion || tableSize > file->GetSize())
+	{
+		std::cout << "Warning: '" << path << "' is not a valid asset archive" << std::endl;
+		return false;
+	}
+
+	//Every name has to end inside the names block, which the
+	//last byte of the block being a terminator guarantees
+	const ArchiveEntry* entries = (const ArchiveEntry*)(header + 1);
+	const char* names = (const char*)(entries + header->entryCount);
+	if (header->entryCount > 0 && (header->namesSize == 0 || names[header->namesSize - 1] != '\0'))
+	{
+		std::cout << "Warning: asset archive '" << path << "' has a corrupt name table" << std::endl;
+		return false;
+	}
+
+	uint64_t fileSize = file->GetSize();
+	for (uint32_t i = 0; i < header->entryCount; i++)
+	{
+		const ArchiveEntry& entry = entries[i];
+		if (entry.nameOffset >= header->namesSize || entry.compression != None || entry.size != entry.storedSize)
+		{
+			std::cout << "Warning: asset archive '" << path << "' has a corrupt entry" << std::endl;
+			return false;
+		}
+		if (entry.offset > fileSize || entry.storedSize > fileSize - entry.offset)
+		{
+			std::cout << "Warning: asset archive '" << path << "' is truncated" << std::endl;
+			return false;
+		}
+	}
+
+	m_File = std::move(file);
+	m_Header = header;
+	m_Entries = entries;
+	m_Names = names;
+	return true;
+}
+
+void AssetArchive::Unmount()
+{
+	m_Header = nullptr;
+	m_Entries = nullptr;
+	m_Names = nullptr;
+	m_File.reset();
+}
+
+const AssetArchive::ArchiveEntry* AssetArchive::Find(const std::string& path) const
+{
+	if (!IsMounted())
+		return nullptr;
+
+	std::string name = NormalizePath(path);
+	uint64_t hash = HashFNV1a(name.data(), name.size());
+
+	const ArchiveEntry* end = m_Entries + m_Header->entryCount;
+	const ArchiveEntry* entry = std::lower_bound(m_Entries, end, hash, [](const ArchiveEntry& entry, uint64_t hash) {
+		return entry.pathHash < hash;
+	});
+
+	for (; entry != end && entry->pathHash == hash; entry++)
+	{
+		if (name == m_Names + entry->nameOffset)
+			return entry;
+	}
+	return nullptr;
+}
+
+AssetData AssetArchive::Read(const std::string& path) const
+{
+	MEMORY_TAG(Assets);
+	AssetData data;
+
+	if (const ArchiveEntry* entry = Find(path))
+	{
+		const unsigned char* stored = m_File->GetData() + entry->offset;
+		if (entry->compression == None)
+		{
+			data.m_Data = stored;
+			data.m_Size = (size_t)entry->size;
+		}
+
+#ifdef _DEBUG
+		//Catches archives that were damaged or edited after packing
+		if (data.m_Data && HashFNV1a(data.m_Data, data.m_Size) != entry->contentHash)
+		{
+			std::cout << "Warning: asset '" << path << "' doesn't match its content hash" << std::endl;
+			data.m_Data = nullptr;
+		}
+#endif
+		if (data.m_Data)
+			return data;
+
+		std::cout << "Warning: asset '" << path << "' couldn't be read from the archive" << std::endl;
+	}
+
+	data.m_File = std::make_unique<MappedFile>(path);
+	if (data.m_File->IsOpen())
+	{
+		data.m_Data = data.m_File->GetData();
+		data.m_Size = data.m_File->GetSize();
+	}
+	return data;
+}
+
+bool AssetArchive::Build(const std::string& directory, const std::string& archivePath)
+{
+	struct Source {
+		std::string name;
+		std::vector<unsigned char> data;
+		ArchiveEntry entry;
+	};
+
+	//Entries are named from the packed directory itself, so packing either
+	//res or baked/res gives the same names as the code uses ('res/...')
+	std::filesystem::path root = std::filesystem::path(directory).lexically_normal();
+	if (!root.has_filename())
+		root = root.parent_path();
+
+	std::vector<Source> sources;
+	std::error_code error;
+	for (const auto& file : std::filesystem::recursive_directory_iterator(directory, error))
+	{
+		if (!file.is_regular_file())
+			continue;
+
+		Source source;
+		source.name = NormalizePath((root.filename() / file.path().lexically_relative(directory)).generic_string());
+
+		std::ifstream stream(file.path(), std::ios::binary);
+		source.data.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+
+		source.entry = {};
+		source.entry.pathHash = HashFNV1a(source.name.data(), source.name.size());
+		source.entry.contentHash = HashFNV1a(source.data.data(), source.data.size());
+		source.entry.size = source.data.size();
+		source.entry.storedSize = source.data.size();
+		source.entry.compression = None;
+
+		sources.push_back(std::move(source));
+	}
+
+	if (error)
+	{
+		std::cout << "Failed to read '" << directory << "': " << error.message() << std::endl;
+		return false;
+	}
+
+	std::sort(sources.begin(), sources.end(), [](const Source& a, const Source& b) {
+		return a.entry.pathHash < b.entry.pathHash;
+	});
+
+	std::string names;
+	for (Source& source : sources)
+	{
+		source.entry.nameOffset = (uint32_t)names.size();
+		names += source.name;
+		names += '\0';
+	}
+
+	uint64_t offset = sizeof(ArchiveHeader) + sources.size() * sizeof(ArchiveEntry) + names.size();
+	for (Source& source : sources)
+	{
+		offset = AlignOffset(offset);
+		source.entry.offset = offset;
+		offset += source.entry.storedSize;
+	}
+
+	std::ofstream stream(archivePath, std::ios::binary | std::ios::trunc);
+	if (!stream)
+	{
+		std::cout << "Failed to create '" << archivePath << "'" << std::endl;
+		return false;
+	}
+
+	ArchiveHeader header;
+	memcpy(header.magic, s_ArchiveMagic, sizeof(s_ArchiveMagic));
+	header.version = ArchiveVersion;
+	header.entryCount = (uint32_t)sources.size();
+	header.namesSize = (uint32_t)names.size();
+	stream.write((const char*)&header, sizeof(header));
+
+	for (const Source& source : sources)
+		stream.write((const char*)&source.entry, sizeof(ArchiveEntry));
+	stream.write(names.data(), names.size());
+
+	static const char padding[ArchiveAlignment] = {};
+	uint64_t position = sizeof(ArchiveHeader) + sources.size() * sizeof(ArchiveEntry) + names.size();
+	for (const Source& source : sources)
+	{
+		stream.write(padding, source.entry.offset - position);
+		stream.write((const char*)source.data.data(), source.data.size());
+		position = source.entry.offset + source.entry.storedSize;
+	}
+
+	std::cout << "Packed " << sources.size() << " files from '" << directory << "' into '" << archivePath << "'" << std::endl;
+	return (bool)stream;
+}
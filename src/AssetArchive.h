@@ -0,0 +1,85 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "MappedFile.h"
+
+//Bytes of a single resource. Archive entries are viewed in place inside the
+//mounted archive and loose files are mapped
+class AssetData
+{
+private:
+	std::unique_ptr<MappedFile> m_File;
+	const unsigned char* m_Data;
+	size_t m_Size;
+
+	friend class AssetArchive;
+public:
+	AssetData();
+
+	inline bool IsValid() const { return m_Data != nullptr; }
+	inline const unsigned char* GetData() const { return m_Data; }
+	inline size_t GetSize() const { return m_Size; }
+};
+
+//Single packed file holding every resource under res/, memory-mapped once at
+//startup so loading a shader or texture doesn't need its own file open.
+//
+//Layout: ArchiveHeader, ArchiveEntry table sorted by path hash, path names,
+//then the entry data with each entry aligned to ArchiveAlignment bytes.
+//Debug builds check each entry read against its content hash
+class AssetArchive
+{
+public:
+	struct ArchiveHeader {
+		char magic[4];
+		uint32_t version;
+		uint32_t entryCount;
+		uint32_t namesSize;
+	};
+
+	struct ArchiveEntry {
+		uint64_t pathHash;
+		uint64_t contentHash;
+		uint64_t offset;
+		uint64_t size;
+		uint64_t storedSize;
+		uint32_t nameOffset;
+		uint32_t compression;
+	};
+
+	//Entries are stored as they are, the field leaves room for a codec
+	enum Compression : uint32_t {
+		None = 0
+	};
+
+	static const uint32_t ArchiveVersion = 1;
+	static const uint64_t ArchiveAlignment = 64;
+
+private:
+	std::unique_ptr<MappedFile> m_File;
+	const ArchiveHeader* m_Header;
+	const ArchiveEntry* m_Entries;
+	const char* m_Names;
+
+	AssetArchive();
+public:
+	static AssetArchive& Get();
+
+	bool Mount(const std::string& path);
+	//Data read from the archive must not outlive the mount
+	void Unmount();
+	inline bool IsMounted() const { return m_Header != nullptr; }
+
+	//Looks the resource up in the mounted archive and falls back to the file system
+	AssetData Read(const std::string& path) const;
+
+	//Packs every file under directory
+	static bool Build(const std::string& directory, const std::string& archivePath);
+
+	static std::string NormalizePath(const std::string& path);
+
+private:
+	const ArchiveEntry* Find(const std::string& path) const;
+};
@@ -0,0 +1,290 @@
+#include "AssetBaker.h"
+#include "Hash.h"
+#include "ImageDecoder.h"
+#include "Shader.h"
+#include "Texture.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+//Bumped whenever the baked output changes so stale manifests rebuild everything
+static const uint64_t s_BakerVersion = 1;
+
+template<typename T>
+static void Append(std::vector<unsigned char>& output, const T& value)
+{
+	const unsigned char* bytes = (const unsigned char*)&value;
+	output.insert(output.end(), bytes, bytes + sizeof(T));
+}
+
+bool AssetBaker::Bake(const std::string& sourceDirectory, const std::string& outputDirectory, bool compress)
+{
+	fs::path manifestPath = fs::path(outputDirectory) / "manifest.txt";
+
+	std::map<std::string, uint64_t> manifest;
+	{
+		std::ifstream stream(manifestPath);
+		std::string name;
+		uint64_t hash;
+		while (stream >> std::hex >> hash && std::getline(stream >> std::ws, name))
+			manifest[name] = hash;
+	}
+
+	std::map<std::string, uint64_t> baked;
+	int built = 0, skipped = 0, failed = 0;
+
+	std::error_code error;
+	for (const auto& file : fs::recursive_directory_iterator(sourceDirectory, error))
+	{
+		if (!file.is_regular_file())
+			continue;
+
+		std::string name = fs::relative(file.path(), sourceDirectory).generic_string();
+		fs::path outputPath = fs::path(outputDirectory) / name;
+
+		std::ifstream stream(file.path(), std::ios::binary);
+		std::vector<unsigned char> source((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+		//Anything that changes the output is part of the hash
+		uint64_t hash = HashFNV1a(source.data(), source.size());
+		hash = HashFNV1a(&s_BakerVersion, sizeof(s_BakerVersion), hash);
+		hash = HashFNV1a(&compress, sizeof(compress), hash);
+
+		auto previous = manifest.find(name);
+		if (previous != manifest.end() && previous->second == hash && fs::exists(outputPath))
+		{
+			baked[name] = hash;
+			skipped++;
+			continue;
+		}
+
+		std::string extension = file.path().extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)tolower(c); });
+
+		std::vector<unsigned char> output;
+		bool success;
+		if (extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".tga" || extension == ".bmp")
+			success = BakeTexture(name, source, output, compress);
+		else if (extension == ".shader")
+			success = BakeShader(name, source, output);
+		else
+		{
+			output = std::move(source);
+			success = true;
+		}
+
+		//A failed bake leaves the last good output in place
+		if (success)
+		{
+			fs::create_directories(outputPath.parent_path(), error);
+			std::ofstream result(outputPath, std::ios::binary | std::ios::trunc);
+			result.write((const char*)output.data(), output.size());
+			success = (bool)result;
+		}
+
+		if (success)
+		{
+			baked[name] = hash;
+			built++;
+		}
+		else
+		{
+			std::cout << "Failed to bake '" << name << "'" << std::endl;
+			failed++;
+		}
+	}
+
+	if (error)
+	{
+		std::cout << "Failed to read '" << sourceDirectory << "': " << error.message() << std::endl;
+		return false;
+	}
+
+	std::ofstream stream(manifestPath, std::ios::trunc);
+	for (const auto& entry : baked)
+		stream << std::hex << std::setw(16) << std::setfill('0') << entry.second << " " << entry.first << "\n";
+
+	std::cout << "Baked " << built << " assets into '" << outputDirectory << "' (" << skipped << " up to date, " << failed << " failed)" << std::endl;
+	return failed == 0;
+}
+
+bool AssetBaker::BakeTexture(const std::string& name, const std::vector<unsigned char>& source, std::vector<unsigned char>& output, bool compress)
+{
+	ImageDecoder& decoder = ImageDecoder::Get();
+	int width, height, channels;
+	unsigned char* pixels = decoder.Decode(source.data(), source.size(), width, height, channels, 4);
+	if (!pixels)
+	{
+		std::cout << "Couldn't decode texture '" << name << "'" << std::endl;
+		return false;
+	}
+
+	//Each level is a 2x2 box filter of the one above it
+	std::vector<std::vector<unsigned char>> levels;
+	levels.emplace_back(pixels, pixels + (size_t)width * height * 4);
+	decoder.Free(pixels);
+
+	for (int w = width, h = height; w > 1 || h > 1;)
+	{
+		int levelWidth = std::max(1, w / 2);
+		int levelHeight = std::max(1, h / 2);
+		const std::vector<unsigned char>& above = levels.back();
+		std::vector<unsigned char> level((size_t)levelWidth * levelHeight * 4);
+
+		for (int y = 0; y < levelHeight; y++)
+		{
+			int y0 = std::min(y * 2, h - 1), y1 = std::min(y * 2 + 1, h - 1);
+			for (int x = 0; x < levelWidth; x++)
+			{
+				int x0 = std::min(x * 2, w - 1), x1 = std::min(x * 2 + 1, w - 1);
+				for (int c = 0; c < 4; c++)
+				{
+					int sum = above[((size_t)y0 * w + x0) * 4 + c] + above[((size_t)y0 * w + x1) * 4 + c] +
+						above[((size_t)y1 * w + x0) * 4 + c] + above[((size_t)y1 * w + x1) * 4 + c];
+					level[((size_t)y * levelWidth + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+				}
+			}
+		}
+
+		levels.push_back(std::move(level));
+		w = levelWidth;
+		h = levelHeight;
+	}
+
+	BakedTextureHeader header;
+	memcpy(header.magic, BakedTextureHeader::Magic, sizeof(header.magic));
+	header.version = BakedTextureHeader::Version;
+	header.width = width;
+	header.height = height;
+	header.levels = (uint32_t)levels.size();
+	header.channels = 4;
+	header.internalFormat = GL_RGBA8;
+	header.format = GL_RGBA;
+
+	//The driver does the block compression, every desktop GL driver
+	//that exposes S3TC can also encode it
+	if (compress && GLEW_EXT_texture_compression_s3tc)
+	{
+		unsigned int texture;
+		GLCall(glGenTextures(1, &texture));
+		GLCall(glBindTexture(GL_TEXTURE_2D, texture));
+		for (uint32_t i = 0; i < header.levels; i++)
+		{
+			int levelWidth = std::max(1, width >> i);
+			int levelHeight = std::max(1, height >> i);
+			GLCall(glTexImage2D(GL_TEXTURE_2D, i, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, levelWidth, levelHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, levels[i].data()));
+
+			GLint size = 0;
+			GLCall(glGetTexLevelParameteriv(GL_TEXTURE_2D, i, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &size));
+			levels[i].resize(size);
+			GLCall(glGetCompressedTexImage(GL_TEXTURE_2D, i, levels[i].data()));
+		}
+		GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+		GLCall(glDeleteTextures(1, &texture));
+
+		header.internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		header.format = 0;
+	}
+
+	Append(output, header);
+	for (const std::vector<unsigned char>& level : levels)
+		Append(output, (uint32_t)level.size());
+	for (const std::vector<unsigned char>& level : levels)
+		output.insert(output.end(), level.begin(), level.end());
+
+	return true;
+}
+
+bool AssetBaker::BakeShader(const std::string& name, const std::vector<unsigned char>& source, std::vector<unsigned char>& output)
+{
+	ShaderProgramSource program = Shader::ParseShaderSource(StripComments(std::string(source.begin(), source.end())));
+	if (program.VertexSource.empty() || program.FragmentSource.empty())
+	{
+		std::cout << "Shader '" << name << "' is missing a vertex or fragment stage" << std::endl;
+		return false;
+	}
+
+	unsigned int vs = Shader::CompileShader(GL_VERTEX_SHADER, program.VertexSource);
+	unsigned int fs = Shader::CompileShader(GL_FRAGMENT_SHADER, program.FragmentSource);
+	bool linked = false;
+	if (vs && fs)
+	{
+		unsigned int id = glCreateProgram();
+		GLCall(glAttachShader(id, vs));
+		GLCall(glAttachShader(id, fs));
+		GLCall(glLinkProgram(id));
+
+		int result;
+		GLCall(glGetProgramiv(id, GL_LINK_STATUS, &result));
+		linked = result == GL_TRUE;
+		if (!linked)
+		{
+			char message[1024];
+			GLCall(glGetProgramInfoLog(id, sizeof(message), nullptr, message));
+			std::cout << "Failed to link shader '" << name << "'" << std::endl;
+			std::cout << message << std::endl;
+		}
+		GLCall(glDeleteProgram(id));
+	}
+	GLCall(glDeleteShader(vs));
+	GLCall(glDeleteShader(fs));
+
+	if (!linked)
+		return false;
+
+	BakedShaderHeader header;
+	memcpy(header.magic, BakedShaderHeader::Magic, sizeof(header.magic));
+	header.version = BakedShaderHeader::Version;
+	header.vertexSize = (uint32_t)program.VertexSource.size();
+	header.fragmentSize = (uint32_t)program.FragmentSource.size();
+
+	Append(output, header);
+	output.insert(output.end(), program.VertexSource.begin(), program.VertexSource.end());
+	output.insert(output.end(), program.FragmentSource.begin(), program.FragmentSource.end());
+	return true;
+}
+
+std::string AssetBaker::StripComments(const std::string& source)
+{
+	//Removes comments, trailing whitespace and blank lines
+	std::string code;
+	code.reserve(source.size());
+	for (size_t i = 0; i < source.size(); i++)
+	{
+		if (source.compare(i, 2, "//") == 0)
+		{
+			while (i < source.size() && source[i] != '\n')
+				i++;
+		}
+		else if (source.compare(i, 2, "/*") == 0)
+		{
+			size_t end = source.find("*/", i + 2);
+			i = end == std::string::npos ? source.size() : end + 1;
+			continue;
+		}
+
+		if (i < source.size() && source[i] != '\r')
+			code += source[i];
+	}
+
+	std::istringstream stream(code);
+	std::string stripped;
+	std::string line;
+	while (std::getline(stream, line))
+	{
+		line.erase(line.find_last_not_of(" \t") + 1);
+		if (!line.empty())
+			stripped += line + '\n';
+	}
+	return stripped;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//Offline preprocessing of everything under res/ so that loading at runtime is
+//a straight upload: textures are decoded, flipped, mipmapped and optionally
+//S3TC compressed, shaders are split into stages, stripped and validated.
+//Other files are copied as they are. A manifest of content hashes in the
+//output directory lets unchanged sources be skipped on the next bake
+class AssetBaker
+{
+public:
+	//Needs a current GL context to validate shaders and compress textures
+	static bool Bake(const std::string& sourceDirectory, const std::string& outputDirectory, bool compress);
+
+private:
+	static bool BakeTexture(const std::string& name, const std::vector<unsigned char>& source, std::vector<unsigned char>& output, bool compress);
+	static bool BakeShader(const std::string& name, const std::vector<unsigned char>& source, std::vector<unsigned char>& output);
+	static std::string StripComments(const std::string& source);
+};
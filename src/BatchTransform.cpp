@@ -0,0 +1,274 @@
+#include "BatchTransform.h"
+
+#include <cmath>
+
+#include "SIMD.h"
+
+#include "glm/gtc/type_ptr.hpp"
+
+void TransformArrays::Resize(size_t count)
+{
+	X.resize(count, 0.0f);
+	Y.resize(count, 0.0f);
+	Z.resize(count, 0.0f);
+	Cos.resize(count, 1.0f);
+	Sin.resize(count, 0.0f);
+	ScaleX.resize(count, 1.0f);
+	ScaleY.resize(count, 1.0f);
+}
+
+void TransformArrays::Set(size_t index, const glm::vec3& position, float rotation, const glm::vec2& scale)
+{
+	X[index] = position.x;
+	Y[index] = position.y;
+	Z[index] = position.z;
+	Cos[index] = std::cos(rotation);
+	Sin[index] = std::sin(rotation);
+	ScaleX[index] = scale.x;
+	ScaleY[index] = scale.y;
+}
+
+void TransformArrays::Gather(const TransformArrays& source, const unsigned int* indices, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		unsigned int index = indices[i];
+		X[i] = source.X[index];
+		Y[i] = source.Y[index];
+		Z[i] = source.Z[index];
+		Cos[i] = source.Cos[index];
+		Sin[i] = source.Sin[index];
+		ScaleX[i] = source.ScaleX[index];
+		ScaleY[i] = source.ScaleY[index];
+	}
+}
+
+//With model = T * R * S the columns of the model matrix are
+//(c*sx, s*sx, 0, 0), (-s*sy, c*sy, 0, 0), (0, 0, 1, 0), (x, y, z, 1)
+//so every column of viewProjection * model only needs its first
+//two or four columns weighted by those, and column 2 is unchanged
+static void ComputeScalar(const TransformArrays& t, size_t begin, size_t end, const glm::mat4& vp, glm::mat4* out)
+{
+	for (size_t i = begin; i < end; i++)
+	{
+		float c = t.Cos[i], s = t.Sin[i];
+		float sx = t.ScaleX[i], sy = t.ScaleY[i];
+
+		glm::mat4& m = out[i];
+		m[0] = vp[0] * (c * sx) + vp[1] * (s * sx);
+		m[1] = vp[1] * (c * sy) - vp[0] * (s * sy);
+		m[2] = vp[2];
+		m[3] = vp[0] * t.X[i] + vp[1] * t.Y[i] + vp[2] * t.Z[i] + vp[3];
+	}
+}
+
+//The corners of the unit quad are p -/+ a -/+ b, with a and b its
+//half extents along the rotated and scaled x and y axes
+static void ComputeQuadsScalar(const TransformArrays& t, size_t begin, size_t end, QuadVertex* out)
+{
+	for (size_t i = begin; i < end; i++)
+	{
+		glm::vec2 p(t.X[i], t.Y[i]);
+		glm::vec2 a = glm::vec2(t.Cos[i], t.Sin[i]) * (t.ScaleX[i] * 0.5f);
+		glm::vec2 b = glm::vec2(-t.Sin[i], t.Cos[i]) * (t.ScaleY[i] * 0.5f);
+
+		QuadVertex* v = out + i * 4;
+		v[0] = { p - a - b, glm::vec2(0.0f, 0.0f) };
+		v[1] = { p + a - b, glm::vec2(1.0f, 0.0f) };
+		v[2] = { p + a + b, glm::vec2(1.0f, 1.0f) };
+		v[3] = { p - a + b, glm::vec2(0.0f, 1.0f) };
+	}
+}
+
+#ifdef SIMD_X86
+
+static size_t ComputeQuadsSSE(const TransformArrays& t, size_t begin, size_t end, QuadVertex* out)
+{
+	const __m128 half = _mm_set1_ps(0.5f);
+	//Each corner's texture coordinate twice, to fill the upper or lower half of a vertex
+	const __m128 texCoords[4] = {
+		_mm_setr_ps(0.0f, 0.0f, 0.0f, 0.0f),
+		_mm_setr_ps(1.0f, 0.0f, 1.0f, 0.0f),
+		_mm_setr_ps(1.0f, 1.0f, 1.0f, 1.0f),
+		_mm_setr_ps(0.0f, 1.0f, 0.0f, 1.0f)
+	};
+
+	size_t i = begin;
+	for (; i + 4 <= end; i += 4)
+	{
+		__m128 c = _mm_loadu_ps(&t.Cos[i]), s = _mm_loadu_ps(&t.Sin[i]);
+		__m128 hx = _mm_mul_ps(_mm_loadu_ps(&t.ScaleX[i]), half);
+		__m128 hy = _mm_mul_ps(_mm_loadu_ps(&t.ScaleY[i]), half);
+		__m128 x = _mm_loadu_ps(&t.X[i]), y = _mm_loadu_ps(&t.Y[i]);
+
+		__m128 ax = _mm_mul_ps(c, hx), ay = _mm_mul_ps(s, hx);
+		__m128 bx = _mm_mul_ps(s, hy), by = _mm_mul_ps(c, hy);
+
+		//b is (-s, c) * hy, so its x is subtracted where b is added
+		__m128 cornersX[4] = {
+			_mm_add_ps(_mm_sub_ps(x, ax), bx),
+			_mm_add_ps(_mm_add_ps(x, ax), bx),
+			_mm_sub_ps(_mm_add_ps(x, ax), bx),
+			_mm_sub_ps(_mm_sub_ps(x, ax), bx)
+		};
+		__m128 cornersY[4] = {
+			_mm_sub_ps(_mm_sub_ps(y, ay), by),
+			_mm_sub_ps(_mm_add_ps(y, ay), by),
+			_mm_add_ps(_mm_add_ps(y, ay), by),
+			_mm_add_ps(_mm_sub_ps(y, ay), by)
+		};
+
+		float* v = &out[i * 4].Position.x;
+		for (int corner = 0; corner < 4; corner++)
+		{
+			//xy pairs for objects 0 and 1, then 2 and 3
+			__m128 low = _mm_unpacklo_ps(cornersX[corner], cornersY[corner]);
+			__m128 high = _mm_unpackhi_ps(cornersX[corner], cornersY[corner]);
+			_mm_storeu_ps(v + corner * 4, _mm_movelh_ps(low, texCoords[corner]));
+			_mm_storeu_ps(v + 16 + corner * 4, _mm_movehl_ps(texCoords[corner], low));
+			_mm_storeu_ps(v + 32 + corner * 4, _mm_movelh_ps(high, texCoords[corner]));
+			_mm_storeu_ps(v + 48 + corner * 4, _mm_movehl_ps(texCoords[corner], high));
+		}
+	}
+	return i;
+}
+
+static size_t ComputeSSE(const TransformArrays& t, size_t begin, size_t end, const glm::mat4& vp, glm::mat4* out)
+{
+	//Every element of the view projection broadcast to all lanes
+	__m128 v[4][4];
+	for (int column = 0; column < 4; column++)
+		for (int row = 0; row < 4; row++)
+			v[column][row] = _mm_set1_ps(vp[column][row]);
+	__m128 column2 = _mm_loadu_ps(glm::value_ptr(vp) + 8);
+
+	size_t i = begin;
+	for (; i + 4 <= end; i += 4)
+	{
+		__m128 c = _mm_loadu_ps(&t.Cos[i]), s = _mm_loadu_ps(&t.Sin[i]);
+		__m128 sx = _mm_loadu_ps(&t.ScaleX[i]), sy = _mm_loadu_ps(&t.ScaleY[i]);
+		__m128 x = _mm_loadu_ps(&t.X[i]), y = _mm_loadu_ps(&t.Y[i]), z = _mm_loadu_ps(&t.Z[i]);
+
+		__m128 csx = _mm_mul_ps(c, sx), ssx = _mm_mul_ps(s, sx);
+		__m128 csy = _mm_mul_ps(c, sy), ssy = _mm_mul_ps(s, sy);
+
+		//One register per matrix element, holding it for all 4 objects
+		__m128 m0[4], m1[4], m3[4];
+		for (int row = 0; row < 4; row++)
+		{
+			m0[row] = _mm_add_ps(_mm_mul_ps(v[0][row], csx), _mm_mul_ps(v[1][row], ssx));
+			m1[row] = _mm_sub_ps(_mm_mul_ps(v[1][row], csy), _mm_mul_ps(v[0][row], ssy));
+			m3[row] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(v[0][row], x), _mm_mul_ps(v[1][row], y)),
+				_mm_add_ps(_mm_mul_ps(v[2][row], z), v[3][row]));
+		}
+
+		//Turns element-per-register into column-per-register
+		_MM_TRANSPOSE4_PS(m0[0], m0[1], m0[2], m0[3]);
+		_MM_TRANSPOSE4_PS(m1[0], m1[1], m1[2], m1[3]);
+		_MM_TRANSPOSE4_PS(m3[0], m3[1], m3[2], m3[3]);
+
+		for (int k = 0; k < 4; k++)
+		{
+			float* m = glm::value_ptr(out[i + k]);
+			_mm_storeu_ps(m, m0[k]);
+			_mm_storeu_ps(m + 4, m1[k]);
+			_mm_storeu_ps(m + 8, column2);
+			_mm_storeu_ps(m + 12, m3[k]);
+		}
+	}
+	return i;
+}
+
+SIMD_AVX_FUNCTION static inline void Transpose4x2(__m256& r0, __m256& r1, __m256& r2, __m256& r3)
+{
+	__m256 t0 = _mm256_unpacklo_ps(r0, r1);
+	__m256 t1 = _mm256_unpacklo_ps(r2, r3);
+	__m256 t2 = _mm256_unpackhi_ps(r0, r1);
+	__m256 t3 = _mm256_unpackhi_ps(r2, r3);
+	r0 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+	r1 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+	r2 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+	r3 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+}
+
+SIMD_AVX_FUNCTION static size_t ComputeAVX(const TransformArrays& t, size_t begin, size_t end, const glm::mat4& vp, glm::mat4* out)
+{
+	__m256 v[4][4];
+	for (int column = 0; column < 4; column++)
+		for (int row = 0; row < 4; row++)
+			v[column][row] = _mm256_set1_ps(vp[column][row]);
+	__m256 column2 = _mm256_broadcast_ps((const __m128*)(glm::value_ptr(vp) + 8));
+
+	size_t i = begin;
+	for (; i + 8 <= end; i += 8)
+	{
+		__m256 c = _mm256_loadu_ps(&t.Cos[i]), s = _mm256_loadu_ps(&t.Sin[i]);
+		__m256 sx = _mm256_loadu_ps(&t.ScaleX[i]), sy = _mm256_loadu_ps(&t.ScaleY[i]);
+		__m256 x = _mm256_loadu_ps(&t.X[i]), y = _mm256_loadu_ps(&t.Y[i]), z = _mm256_loadu_ps(&t.Z[i]);
+
+		__m256 csx = _mm256_mul_ps(c, sx), ssx = _mm256_mul_ps(s, sx);
+		__m256 csy = _mm256_mul_ps(c, sy), ssy = _mm256_mul_ps(s, sy);
+
+		__m256 m0[4], m1[4], m3[4];
+		for (int row = 0; row < 4; row++)
+		{
+			m0[row] = _mm256_add_ps(_mm256_mul_ps(v[0][row], csx), _mm256_mul_ps(v[1][row], ssx));
+			m1[row] = _mm256_sub_ps(_mm256_mul_ps(v[1][row], csy), _mm256_mul_ps(v[0][row], ssy));
+			m3[row] = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(v[0][row], x), _mm256_mul_ps(v[1][row], y)),
+				_mm256_add_ps(_mm256_mul_ps(v[2][row], z), v[3][row]));
+		}
+
+		//Transposes within each 128 bit lane, leaving register k with the
+		//column for object k in the low lane and object k + 4 in the high one
+		Transpose4x2(m0[0], m0[1], m0[2], m0[3]);
+		Transpose4x2(m1[0], m1[1], m1[2], m1[3]);
+		Transpose4x2(m3[0], m3[1], m3[2], m3[3]);
+
+		for (int k = 0; k < 4; k++)
+		{
+			float* low = glm::value_ptr(out[i + k]);
+			float* high = glm::value_ptr(out[i + k + 4]);
+			_mm256_storeu_ps(low, _mm256_permute2f128_ps(m0[k], m1[k], 0x20));
+			_mm256_storeu_ps(low + 8, _mm256_permute2f128_ps(column2, m3[k], 0x20));
+			_mm256_storeu_ps(high, _mm256_permute2f128_ps(m0[k], m1[k], 0x31));
+			_mm256_storeu_ps(high + 8, _mm256_permute2f128_ps(column2, m3[k], 0x31));
+		}
+	}
+	return i;
+}
+
+#endif
+
+void BatchTransform::ComputeMVP(const TransformArrays& transforms, size_t begin, size_t end, const glm::mat4& viewProjection, glm::mat4* out)
+{
+	//Whatever doesn't fill a whole vector is finished by the scalar loop
+#ifdef SIMD_X86
+	switch (SIMD::GetLevel())
+	{
+	case SIMDLevel::AVX:
+		begin = ComputeAVX(transforms, begin, end, viewProjection, out);
+		break;
+	case SIMDLevel::SSE:
+		begin = ComputeSSE(transforms, begin, end, viewProjection, out);
+		break;
+	default:
+		break;
+	}
+#endif
+	ComputeScalar(transforms, begin, end, viewProjection, out);
+}
+
+void BatchTransform::ComputeQuads(const TransformArrays& transforms, size_t begin, size_t end, QuadVertex* out)
+{
+	//Only 4 floats are written per vertex, so AVX has nothing to add over SSE here
+#ifdef SIMD_X86
+	if (SIMD::GetLevel() != SIMDLevel::Scalar)
+		begin = ComputeQuadsSSE(transforms, begin, end, out);
+#endif
+	ComputeQuadsScalar(transforms, begin, end, out);
+}
+
+void BatchTransform::ComputeModel(const TransformArrays& transforms, size_t begin, size_t end, glm::mat4* out)
+{
+	ComputeMVP(transforms, begin, end, glm::mat4(1.0f), out);
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+//Per object transforms (translation, rotation about z, scale) in structure of
+//arrays layout, so the same field of 4 or 8 objects can be loaded at once.
+//Rotations are kept as their cosine and sine rather than an angle
+struct TransformArrays {
+	std::vector<float> X, Y, Z;
+	std::vector<float> Cos, Sin;
+	std::vector<float> ScaleX, ScaleY;
+
+	void Resize(size_t count);
+	void Set(size_t index, const glm::vec3& position, float rotation, const glm::vec2& scale);
+	//Copies the listed objects of source to the front of these arrays, which must be large enough
+	void Gather(const TransformArrays& source, const unsigned int* indices, size_t count);
+	inline size_t GetCount() const { return X.size(); }
+};
+
+//One corner of a pretransformed sprite
+struct QuadVertex {
+	glm::vec2 Position;
+	glm::vec2 TexCoord;
+};
+
+//Builds the matrices of many objects at once, with the kernels for SIMD::GetLevel. The model matrix is
+//translate * rotate * scale, the same as composing them with glm. The SSE and
+//AVX kernels build 4 or 8 matrices per iteration from the arrays, then
+//transpose them into ordinary column major glm::mat4s
+class BatchTransform
+{
+public:
+	//Writes viewProjection * model for objects [begin, end) to out[begin, end)
+	static void ComputeMVP(const TransformArrays& transforms, size_t begin, size_t end, const glm::mat4& viewProjection, glm::mat4* out);
+	static void ComputeModel(const TransformArrays& transforms, size_t begin, size_t end, glm::mat4* out);
+	//Transforms a unit quad centred on the origin by each object's model matrix, ignoring z,
+	//writing 4 vertices per object counter clockwise from the bottom left to out[4 * begin, 4 * end)
+	static void ComputeQuads(const TransformArrays& transforms, size_t begin, size_t end, QuadVertex* out);
+};
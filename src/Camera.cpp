@@ -0,0 +1,233 @@
+#include "Camera.h"
+
+#include <cmath>
+
+#include "glm/gtc/matrix_transform.hpp"
+
+Frustum Frustum::FromMatrix(const glm::mat4& viewProjection)
+{
+	//The rows of the matrix, glm is column major
+	glm::vec4 rows[4];
+	for (int i = 0; i < 4; i++)
+		rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+
+	Frustum frustum;
+	frustum.Planes[Left] = rows[3] + rows[0];
+	frustum.Planes[Right] = rows[3] - rows[0];
+	frustum.Planes[Bottom] = rows[3] + rows[1];
+	frustum.Planes[Top] = rows[3] - rows[1];
+	frustum.Planes[Near] = rows[3] + rows[2];
+	frustum.Planes[Far] = rows[3] - rows[2];
+
+	for (glm::vec4& plane : frustum.Planes)
+		plane /= glm::length(glm::vec3(plane));
+	return frustum;
+}
+
+bool Frustum::ContainsPoint(const glm::vec3& point) const
+{
+	return IntersectsSphere(point, 0.0f);
+}
+
+bool Frustum::IntersectsSphere(const glm::vec3& center, float radius) const
+{
+	for (const glm::vec4& plane : Planes)
+	{
+		if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+			return false;
+	}
+	return true;
+}
+
+bool Frustum::IntersectsAABB(const glm::vec3& min, const glm::vec3& max) const
+{
+	for (const glm::vec4& plane : Planes)
+	{
+		//The corner furthest along the plane's normal
+		glm::vec3 corner(plane.x >= 0.0f ? max.x : min.x, plane.y >= 0.0f ? max.y : min.y, plane.z >= 0.0f ? max.z : min.z);
+		if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f)
+			return false;
+	}
+	return true;
+}
+
+Camera::Camera()
+	: m_View(1.0f), m_Projection(1.0f), m_ViewProjection(1.0f), m_Frustum(),
+	m_ViewDirty(true), m_ProjectionDirty(true), m_ViewProjectionDirty(true), m_FrustumDirty(true),
+	m_Version(0), m_Position(0.0f)
+{
+}
+
+void Camera::InvalidateView()
+{
+	m_ViewDirty = true;
+	m_ViewProjectionDirty = true;
+	m_FrustumDirty = true;
+	m_Version++;
+}
+
+void Camera::InvalidateProjection()
+{
+	m_ProjectionDirty = true;
+	m_ViewProjectionDirty = true;
+	m_FrustumDirty = true;
+	m_Version++;
+}
+
+void Camera::SetPosition(const glm::vec3& position)
+{
+	if (position == m_Position)
+		return;
+
+	m_Position = position;
+	InvalidateView();
+}
+
+const glm::mat4& Camera::GetView() const
+{
+	if (m_ViewDirty)
+	{
+		m_View = CalculateView();
+		m_ViewDirty = false;
+	}
+	return m_View;
+}
+
+const glm::mat4& Camera::GetProjection() const
+{
+	if (m_ProjectionDirty)
+	{
+		m_Projection = CalculateProjection();
+		m_ProjectionDirty = false;
+	}
+	return m_Projection;
+}
+
+const glm::mat4& Camera::GetViewProjection() const
+{
+	if (m_ViewProjectionDirty)
+	{
+		m_ViewProjection = GetProjection() * GetView();
+		m_ViewProjectionDirty = false;
+	}
+	return m_ViewProjection;
+}
+
+const Frustum& Camera::GetFrustum() const
+{
+	if (m_FrustumDirty)
+	{
+		m_Frustum = Frustum::FromMatrix(GetViewProjection());
+		m_FrustumDirty = false;
+	}
+	return m_Frustum;
+}
+
+OrthographicCamera::OrthographicCamera(float left, float right, float bottom, float top, float nearPlane, float farPlane)
+	: m_Left(left), m_Right(right), m_Bottom(bottom), m_Top(top), m_NearPlane(nearPlane), m_FarPlane(farPlane), m_Rotation(0.0f)
+{
+}
+
+void OrthographicCamera::SetProjection(float left, float right, float bottom, float top, float nearPlane, float farPlane)
+{
+	m_Left = left;
+	m_Right = right;
+	m_Bottom = bottom;
+	m_Top = top;
+	m_NearPlane = nearPlane;
+	m_FarPlane = farPlane;
+	InvalidateProjection();
+}
+
+void OrthographicCamera::SetRotation(float rotation)
+{
+	if (rotation == m_Rotation)
+		return;
+
+	m_Rotation = rotation;
+	InvalidateView();
+}
+
+glm::mat4 OrthographicCamera::CalculateView() const
+{
+	glm::mat4 transform = glm::translate(glm::mat4(1.0f), m_Position);
+	transform = glm::rotate(transform, m_Rotation, glm::vec3(0.0f, 0.0f, 1.0f));
+	return glm::inverse(transform);
+}
+
+glm::mat4 OrthographicCamera::CalculateProjection() const
+{
+	return glm::ortho(m_Left, m_Right, m_Bottom, m_Top, m_NearPlane, m_FarPlane);
+}
+
+PerspectiveCamera::PerspectiveCamera(float fieldOfView, float aspectRatio, float nearPlane, float farPlane)
+	: m_FieldOfView(fieldOfView), m_AspectRatio(aspectRatio), m_NearPlane(nearPlane), m_FarPlane(farPlane), m_Pitch(0.0f), m_Yaw(0.0f)
+{
+}
+
+void PerspectiveCamera::SetPerspective(float fieldOfView, float aspectRatio, float nearPlane, float farPlane)
+{
+	m_FieldOfView = fieldOfView;
+	m_AspectRatio = aspectRatio;
+	m_NearPlane = nearPlane;
+	m_FarPlane = farPlane;
+	InvalidateProjection();
+}
+
+void PerspectiveCamera::SetAspectRatio(float aspectRatio)
+{
+	if (aspectRatio == m_AspectRatio)
+		return;
+
+	m_AspectRatio = aspectRatio;
+	InvalidateProjection();
+}
+
+void PerspectiveCamera::SetRotation(float pitch, float yaw)
+{
+	if (pitch == m_Pitch && yaw == m_Yaw)
+		return;
+
+	m_Pitch = pitch;
+	m_Yaw = yaw;
+	InvalidateView();
+}
+
+glm::vec3 PerspectiveCamera::GetForward() const
+{
+	return glm::vec3(std::sin(m_Yaw) * std::cos(m_Pitch), std::sin(m_Pitch), -std::cos(m_Yaw) * std::cos(m_Pitch));
+}
+
+glm::mat4 PerspectiveCamera::CalculateView() const
+{
+	return glm::lookAt(m_Position, m_Position + GetForward(), glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+glm::mat4 PerspectiveCamera::CalculateProjection() const
+{
+	return glm::perspective(m_FieldOfView, m_AspectRatio, m_NearPlane, m_FarPlane);
+}
+
+const char* CameraBuffer::BlockName = "Camera";
+
+CameraBuffer::CameraBuffer()
+	: m_Buffer(sizeof(CameraUniforms), Binding), m_Camera(nullptr), m_Version(0)
+{
+}
+
+void CameraBuffer::Update(const Camera& camera)
+{
+	m_Buffer.Bind();
+	if (&camera == m_Camera && camera.GetVersion() == m_Version)
+		return;
+
+	CameraUniforms uniforms;
+	uniforms.View = camera.GetView();
+	uniforms.Projection = camera.GetProjection();
+	uniforms.ViewProjection = camera.GetViewProjection();
+	uniforms.Position = glm::vec4(camera.GetPosition(), 1.0f);
+	m_Buffer.SetData(&uniforms, sizeof(uniforms));
+
+	m_Camera = &camera;
+	m_Version = camera.GetVersion();
+}
@@ -0,0 +1,125 @@
+#pragma once
+#include "glm/glm.hpp"
+
+#include "UniformBuffer.h"
+
+//Six planes as (normal, distance) with the normals pointing inwards, so a
+//point p is inside when dot(normal, p) + distance >= 0 for all of them
+struct Frustum {
+	enum Side { Left, Right, Bottom, Top, Near, Far, Count };
+	glm::vec4 Planes[Count];
+
+	//Extracts the planes of the clip volume of a view projection matrix
+	static Frustum FromMatrix(const glm::mat4& viewProjection);
+
+	bool ContainsPoint(const glm::vec3& point) const;
+	bool IntersectsSphere(const glm::vec3& center, float radius) const;
+	bool IntersectsAABB(const glm::vec3& min, const glm::vec3& max) const;
+};
+
+//Caches its view, projection and view projection matrices and its frustum,
+//recalculating each only when something it depends on has changed. The
+//version is bumped on every change so users can skip work for a camera that
+//hasn't moved. The getters write the cache, so they aren't thread safe: read
+//the matrices once before handing them to jobs rather than calling them there
+class Camera
+{
+private:
+	mutable glm::mat4 m_View, m_Projection, m_ViewProjection;
+	mutable Frustum m_Frustum;
+	mutable bool m_ViewDirty, m_ProjectionDirty, m_ViewProjectionDirty, m_FrustumDirty;
+	unsigned int m_Version;
+
+protected:
+	glm::vec3 m_Position;
+
+	Camera();
+	void InvalidateView();
+	void InvalidateProjection();
+	virtual glm::mat4 CalculateView() const = 0;
+	virtual glm::mat4 CalculateProjection() const = 0;
+
+public:
+	virtual ~Camera() {}
+
+	void SetPosition(const glm::vec3& position);
+	inline const glm::vec3& GetPosition() const { return m_Position; }
+
+	const glm::mat4& GetView() const;
+	const glm::mat4& GetProjection() const;
+	const glm::mat4& GetViewProjection() const;
+	const Frustum& GetFrustum() const;
+	inline unsigned int GetVersion() const { return m_Version; }
+};
+
+class OrthographicCamera : public Camera
+{
+private:
+	float m_Left, m_Right, m_Bottom, m_Top, m_NearPlane, m_FarPlane;
+	float m_Rotation;
+
+public:
+	OrthographicCamera(float left, float right, float bottom, float top, float nearPlane = -1.0f, float farPlane = 1.0f);
+
+	void SetProjection(float left, float right, float bottom, float top, float nearPlane = -1.0f, float farPlane = 1.0f);
+	//Radians counter clockwise around z
+	void SetRotation(float rotation);
+	inline float GetRotation() const { return m_Rotation; }
+
+	//The visible rectangle in world space, ignoring rotation
+	inline glm::vec2 GetMin() const { return glm::vec2(m_Position) + glm::vec2(m_Left, m_Bottom); }
+	inline glm::vec2 GetMax() const { return glm::vec2(m_Position) + glm::vec2(m_Right, m_Top); }
+
+protected:
+	glm::mat4 CalculateView() const override;
+	glm::mat4 CalculateProjection() const override;
+};
+
+class PerspectiveCamera : public Camera
+{
+private:
+	float m_FieldOfView, m_AspectRatio, m_NearPlane, m_FarPlane;
+	float m_Pitch, m_Yaw;
+
+public:
+	//Vertical field of view in radians. Looks down -z until rotated
+	PerspectiveCamera(float fieldOfView, float aspectRatio, float nearPlane = 0.1f, float farPlane = 1000.0f);
+
+	void SetPerspective(float fieldOfView, float aspectRatio, float nearPlane, float farPlane);
+	void SetAspectRatio(float aspectRatio);
+	//Radians, pitch up from the horizon and yaw clockwise seen from above
+	void SetRotation(float pitch, float yaw);
+	inline float GetPitch() const { return m_Pitch; }
+	inline float GetYaw() const { return m_Yaw; }
+	glm::vec3 GetForward() const;
+
+protected:
+	glm::mat4 CalculateView() const override;
+	glm::mat4 CalculateProjection() const override;
+};
+
+//Matches the std140 Camera block declared by the shaders
+struct CameraUniforms {
+	glm::mat4 View;
+	glm::mat4 Projection;
+	glm::mat4 ViewProjection;
+	glm::vec4 Position;
+};
+
+//The per frame camera block, kept in sync with whichever camera is passed to
+//Update and uploaded only when that camera or its version changed
+class CameraBuffer
+{
+private:
+	UniformBuffer m_Buffer;
+	const Camera* m_Camera;
+	unsigned int m_Version;
+
+public:
+	static const unsigned int Binding = 0;
+	static const char* BlockName;
+
+	CameraBuffer();
+
+	void Update(const Camera& camera);
+};
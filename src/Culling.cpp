@@ -0,0 +1,257 @@
+#include "Culling.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Camera.h"
+#include "SIMD.h"
+#include "JobSystem.h"
+#include "FrameArena.h"
+
+void BoundsArrays::Resize(size_t count)
+{
+	MinX.resize(count, 0.0f);
+	MinY.resize(count, 0.0f);
+	MinZ.resize(count, 0.0f);
+	MaxX.resize(count, 0.0f);
+	MaxY.resize(count, 0.0f);
+	MaxZ.resize(count, 0.0f);
+}
+
+void BoundsArrays::Set(size_t index, const glm::vec3& min, const glm::vec3& max)
+{
+	MinX[index] = min.x;
+	MinY[index] = min.y;
+	MinZ[index] = min.z;
+	MaxX[index] = max.x;
+	MaxY[index] = max.y;
+	MaxZ[index] = max.z;
+}
+
+//A box is outside a plane when the corner furthest along the plane's normal
+//is behind it. Which corner that is only depends on the signs of the normal,
+//so each plane picks its min or max arrays once for every box
+struct CornerPlane {
+	glm::vec4 plane;
+	const float* x;
+	const float* y;
+	const float* z;
+};
+
+static void GetCornerPlanes(const BoundsArrays& b, const Frustum& frustum, CornerPlane* planes)
+{
+	for (int i = 0; i < Frustum::Count; i++)
+	{
+		const glm::vec4& plane = frustum.Planes[i];
+		planes[i].plane = plane;
+		planes[i].x = plane.x >= 0.0f ? b.MaxX.data() : b.MinX.data();
+		planes[i].y = plane.y >= 0.0f ? b.MaxY.data() : b.MinY.data();
+		planes[i].z = plane.z >= 0.0f ? b.MaxZ.data() : b.MinZ.data();
+	}
+}
+
+static size_t CullFrustumScalar(const CornerPlane* planes, size_t begin, size_t end, unsigned int* visible, size_t& count)
+{
+	for (size_t i = begin; i < end; i++)
+	{
+		bool inside = true;
+		for (int p = 0; p < Frustum::Count && inside; p++)
+		{
+			const CornerPlane& plane = planes[p];
+			inside = plane.plane.x * plane.x[i] + plane.plane.y * plane.y[i] + plane.plane.z * plane.z[i] + plane.plane.w >= 0.0f;
+		}
+
+		visible[count] = (unsigned int)i;
+		count += inside;
+	}
+	return end;
+}
+
+static size_t CullRectScalar(const BoundsArrays& b, size_t begin, size_t end, const glm::vec2& min, const glm::vec2& max, unsigned int* visible, size_t& count)
+{
+	for (size_t i = begin; i < end; i++)
+	{
+		bool inside = b.MaxX[i] >= min.x && b.MinX[i] <= max.x && b.MaxY[i] >= min.y && b.MinY[i] <= max.y;
+		visible[count] = (unsigned int)i;
+		count += inside;
+	}
+	return end;
+}
+
+#ifdef SIMD_X86
+
+//Writes every index and only advances past the ones whose bit is set, which avoids a branch per box
+static inline void AppendVisible(int mask, int lanes, size_t first, unsigned int* visible, size_t& count)
+{
+	for (int lane = 0; lane < lanes; lane++)
+	{
+		visible[count] = (unsigned int)(first + lane);
+		count += (mask >> lane) & 1;
+	}
+}
+
+static size_t CullFrustumSSE(const CornerPlane* planes, size_t begin, size_t end, unsigned int* visible, size_t& count)
+{
+	__m128 normals[Frustum::Count][4];
+	for (int p = 0; p < Frustum::Count; p++)
+		for (int j = 0; j < 4; j++)
+			normals[p][j] = _mm_set1_ps(planes[p].plane[j]);
+	const __m128 zero = _mm_setzero_ps();
+
+	size_t i = begin;
+	for (; i + 4 <= end; i += 4)
+	{
+		int mask = 0xF;
+		//Most boxes are rejected by the first plane or two when most of the scene is off screen
+		for (int p = 0; p < Frustum::Count && mask; p++)
+		{
+			const CornerPlane& plane = planes[p];
+			__m128 distance = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(normals[p][0], _mm_loadu_ps(plane.x + i)), _mm_mul_ps(normals[p][1], _mm_loadu_ps(plane.y + i))),
+				_mm_add_ps(_mm_mul_ps(normals[p][2], _mm_loadu_ps(plane.z + i)), normals[p][3]));
+			mask &= _mm_movemask_ps(_mm_cmpge_ps(distance, zero));
+		}
+		AppendVisible(mask, 4, i, visible, count);
+	}
+	return i;
+}
+
+static size_t CullRectSSE(const BoundsArrays& b, size_t begin, size_t end, const glm::vec2& min, const glm::vec2& max, unsigned int* visible, size_t& count)
+{
+	const __m128 minX = _mm_set1_ps(min.x), minY = _mm_set1_ps(min.y);
+	const __m128 maxX = _mm_set1_ps(max.x), maxY = _mm_set1_ps(max.y);
+
+	size_t i = begin;
+	for (; i + 4 <= end; i += 4)
+	{
+		__m128 x = _mm_and_ps(_mm_cmpge_ps(_mm_loadu_ps(&b.MaxX[i]), minX), _mm_cmple_ps(_mm_loadu_ps(&b.MinX[i]), maxX));
+		__m128 y = _mm_and_ps(_mm_cmpge_ps(_mm_loadu_ps(&b.MaxY[i]), minY), _mm_cmple_ps(_mm_loadu_ps(&b.MinY[i]), maxY));
+		AppendVisible(_mm_movemask_ps(_mm_and_ps(x, y)), 4, i, visible, count);
+	}
+	return i;
+}
+
+SIMD_AVX_FUNCTION static size_t CullFrustumAVX(const CornerPlane* planes, size_t begin, size_t end, unsigned int* visible, size_t& count)
+{
+	__m256 normals[Frustum::Count][4];
+	for (int p = 0; p < Frustum::Count; p++)
+		for (int j = 0; j < 4; j++)
+			normals[p][j] = _mm256_set1_ps(planes[p].plane[j]);
+	const __m256 zero = _mm256_setzero_ps();
+
+	size_t i = begin;
+	for (; i + 8 <= end; i += 8)
+	{
+		int mask = 0xFF;
+		for (int p = 0; p < Frustum::Count && mask; p++)
+		{
+			const CornerPlane& plane = planes[p];
+			__m256 distance = _mm256_add_ps(
+				_mm256_add_ps(_mm256_mul_ps(normals[p][0], _mm256_loadu_ps(plane.x + i)), _mm256_mul_ps(normals[p][1], _mm256_loadu_ps(plane.y + i))),
+				_mm256_add_ps(_mm256_mul_ps(normals[p][2], _mm256_loadu_ps(plane.z + i)), normals[p][3]));
+			mask &= _mm256_movemask_ps(_mm256_cmp_ps(distance, zero, _CMP_GE_OQ));
+		}
+		AppendVisible(mask, 8, i, visible, count);
+	}
+	return i;
+}
+
+SIMD_AVX_FUNCTION static size_t CullRectAVX(const BoundsArrays& b, size_t begin, size_t end, const glm::vec2& min, const glm::vec2& max, unsigned int* visible, size_t& count)
+{
+	const __m256 minX = _mm256_set1_ps(min.x), minY = _mm256_set1_ps(min.y);
+	const __m256 maxX = _mm256_set1_ps(max.x), maxY = _mm256_set1_ps(max.y);
+
+	size_t i = begin;
+	for (; i + 8 <= end; i += 8)
+	{
+		__m256 x = _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(&b.MaxX[i]), minX, _CMP_GE_OQ), _mm256_cmp_ps(_mm256_loadu_ps(&b.MinX[i]), maxX, _CMP_LE_OQ));
+		__m256 y = _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(&b.MaxY[i]), minY, _CMP_GE_OQ), _mm256_cmp_ps(_mm256_loadu_ps(&b.MinY[i]), maxY, _CMP_LE_OQ));
+		AppendVisible(_mm256_movemask_ps(_mm256_and_ps(x, y)), 8, i, visible, count);
+	}
+	return i;
+}
+
+#endif
+
+size_t Culling::CullFrustum(const BoundsArrays& bounds, size_t begin, size_t end, const Frustum& frustum, unsigned int* visible)
+{
+	CornerPlane planes[Frustum::Count];
+	GetCornerPlanes(bounds, frustum, planes);
+
+	size_t count = 0;
+#ifdef SIMD_X86
+	switch (SIMD::GetLevel())
+	{
+	case SIMDLevel::AVX:
+		begin = CullFrustumAVX(planes, begin, end, visible, count);
+		break;
+	case SIMDLevel::SSE:
+		begin = CullFrustumSSE(planes, begin, end, visible, count);
+		break;
+	default:
+		break;
+	}
+#endif
+	CullFrustumScalar(planes, begin, end, visible, count);
+	return count;
+}
+
+size_t Culling::CullRect(const BoundsArrays& bounds, size_t begin, size_t end, const glm::vec2& min, const glm::vec2& max, unsigned int* visible)
+{
+	size_t count = 0;
+#ifdef SIMD_X86
+	switch (SIMD::GetLevel())
+	{
+	case SIMDLevel::AVX:
+		begin = CullRectAVX(bounds, begin, end, min, max, visible, count);
+		break;
+	case SIMDLevel::SSE:
+		begin = CullRectSSE(bounds, begin, end, min, max, visible, count);
+		break;
+	default:
+		break;
+	}
+#endif
+	CullRectScalar(bounds, begin, end, min, max, visible, count);
+	return count;
+}
+
+//Every batch compacts its results into its own part of visible, and
+//the gaps between them are closed afterwards so the order is kept
+template<typename Function>
+static size_t CullParallel(size_t count, unsigned int* visible, Function cull)
+{
+	int batches = (int)((count + Culling::ParallelBatchSize - 1) / Culling::ParallelBatchSize);
+	FrameVector<size_t> visibleCounts(batches);
+
+	JobSystem::Get().ParallelFor(batches, 1, [&](int begin, int end) {
+		for (int batch = begin; batch < end; batch++)
+		{
+			size_t first = batch * Culling::ParallelBatchSize;
+			size_t last = std::min(count, first + Culling::ParallelBatchSize);
+			visibleCounts[batch] = cull(first, last, visible + first);
+		}
+	});
+
+	size_t total = 0;
+	for (int batch = 0; batch < batches; batch++)
+	{
+		memmove(visible + total, visible + batch * Culling::ParallelBatchSize, visibleCounts[batch] * sizeof(unsigned int));
+		total += visibleCounts[batch];
+	}
+	return total;
+}
+
+size_t Culling::CullFrustumParallel(const BoundsArrays& bounds, size_t count, const Frustum& frustum, unsigned int* visible)
+{
+	return CullParallel(count, visible, [&](size_t begin, size_t end, unsigned int* out) {
+		return CullFrustum(bounds, begin, end, frustum, out);
+	});
+}
+
+size_t Culling::CullRectParallel(const BoundsArrays& bounds, size_t count, const glm::vec2& min, const glm::vec2& max, unsigned int* visible)
+{
+	return CullParallel(count, visible, [&](size_t begin, size_t end, unsigned int* out) {
+		return CullRect(bounds, begin, end, min, max, out);
+	});
+}
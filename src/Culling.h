@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+struct Frustum;
+
+//Axis aligned bounding boxes in structure of arrays layout, so the
+//culling kernels can test 4 or 8 boxes against a plane at once
+struct BoundsArrays {
+	std::vector<float> MinX, MinY, MinZ;
+	std::vector<float> MaxX, MaxY, MaxZ;
+
+	void Resize(size_t count);
+	void Set(size_t index, const glm::vec3& min, const glm::vec3& max);
+	inline size_t GetCount() const { return MinX.size(); }
+};
+
+//Finds the boxes that are at least partly visible, with the kernels for
+//SIMD::GetLevel. The indices of the visible boxes are written to visible in
+//increasing order, which needs room for every box tested, and the number of
+//them is returned. Boxes that straddle a plane count as visible
+class Culling
+{
+public:
+	//How many boxes each job of the parallel versions tests
+	static const size_t ParallelBatchSize = 16384;
+
+	static size_t CullFrustum(const BoundsArrays& bounds, size_t begin, size_t end, const Frustum& frustum, unsigned int* visible);
+	//Against a rectangle in the xy plane, ignoring z
+	static size_t CullRect(const BoundsArrays& bounds, size_t begin, size_t end, const glm::vec2& min, const glm::vec2& max, unsigned int* visible);
+
+	//Test boxes [0, count) split across the job system, only call these during a frame
+	static size_t CullFrustumParallel(const BoundsArrays& bounds, size_t count, const Frustum& frustum, unsigned int* visible);
+	static size_t CullRectParallel(const BoundsArrays& bounds, size_t count, const glm::vec2& min, const glm::vec2& max, unsigned int* visible);
+};
@@ -0,0 +1,104 @@
+#include "FrameArena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+std::mutex FrameArena::s_Mutex;
+std::vector<FrameArena*> FrameArena::s_Arenas;
+
+FrameArena::FrameArena()
+	: m_Block(0), m_Offset(0), m_Used(0), m_PeakUsed(0)
+{
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	s_Arenas.push_back(this);
+}
+
+FrameArena::~FrameArena()
+{
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	s_Arenas.erase(std::find(s_Arenas.begin(), s_Arenas.end(), this));
+}
+
+FrameArena& FrameArena::Get()
+{
+	thread_local FrameArena arena;
+	return arena;
+}
+
+void FrameArena::NewFrame()
+{
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	for (FrameArena* arena : s_Arenas)
+	{
+		arena->Reset();
+	}
+}
+
+size_t FrameArena::GetTotalUsed()
+{
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	size_t used = 0;
+	for (FrameArena* arena : s_Arenas)
+	{
+		used += arena->m_Used;
+	}
+	return used;
+}
+
+void* FrameArena::Allocate(size_t size, size_t alignment)
+{
+	if (m_Blocks.empty())
+		AddBlock(size + alignment);
+
+	while (true)
+	{
+		Block& block = m_Blocks[m_Block];
+		uintptr_t base = (uintptr_t)block.memory.get();
+		uintptr_t aligned = (base + m_Offset + alignment - 1) & ~(uintptr_t)(alignment - 1);
+		if (aligned + size <= base + block.size)
+		{
+			m_Used += aligned + size - (base + m_Offset);
+			m_Offset = aligned + size - base;
+			return (void*)aligned;
+		}
+
+		if (m_Block + 1 < m_Blocks.size())
+		{
+			m_Block++;
+			m_Offset = 0;
+		}
+		else
+		{
+			AddBlock(size + alignment);
+		}
+	}
+}
+
+void FrameArena::Reset()
+{
+	m_PeakUsed = std::max(m_PeakUsed, m_Used);
+
+	//Folds the blocks of a frame that overflowed into one big enough for it
+	if (m_Blocks.size() > 1)
+	{
+		size_t total = 0;
+		for (const Block& block : m_Blocks)
+		{
+			total += block.size;
+		}
+		m_Blocks.clear();
+		m_Blocks.push_back({ std::unique_ptr<unsigned char[]>(new unsigned char[total]), total });
+	}
+
+	m_Block = 0;
+	m_Offset = 0;
+	m_Used = 0;
+}
+
+void FrameArena::AddBlock(size_t minimumSize)
+{
+	size_t size = std::max(minimumSize, m_Blocks.empty() ? DefaultBlockSize : m_Blocks.back().size * 2);
+	m_Blocks.push_back({ std::unique_ptr<unsigned char[]>(new unsigned char[size]), size });
+	m_Block = m_Blocks.size() - 1;
+	m_Offset = 0;
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+//Bump allocator for data that only lives until the end of the frame. Every
+//thread allocates from its own arena without locking, and the main loop
+//resets all of them at the start of each frame, when no other thread is
+//working. Memory is never freed individually, and an arena that needed more
+//than one block is reallocated as a single block of the combined size on
+//reset, so after the first few frames allocating never touches the heap
+class FrameArena
+{
+public:
+	static const size_t DefaultBlockSize = 1 << 20;
+
+private:
+	struct Block {
+		std::unique_ptr<unsigned char[]> memory;
+		size_t size;
+	};
+
+	std::vector<Block> m_Blocks;
+	size_t m_Block, m_Offset;
+	size_t m_Used, m_PeakUsed;
+
+	static std::mutex s_Mutex;
+	static std::vector<FrameArena*> s_Arenas;
+
+	FrameArena();
+public:
+	~FrameArena();
+
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator=(const FrameArena&) = delete;
+
+	//The calling thread's arena
+	static FrameArena& Get();
+	static void NewFrame();
+	//Bytes allocated this frame across every thread's arena
+	static size_t GetTotalUsed();
+
+	void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+	template<typename T>
+	T* Allocate(size_t count)
+	{
+		return (T*)Allocate(count * sizeof(T), alignof(T));
+	}
+
+	inline size_t GetUsed() const { return m_Used; }
+	inline size_t GetPeakUsed() const { return m_PeakUsed; }
+
+private:
+	void Reset();
+	void AddBlock(size_t minimumSize);
+};
+
+//Adapts a FrameArena to the standard allocator interface, so containers
+//built during a frame can live in it. Deallocating does nothing, and the
+//container must not be used after the arena is reset
+template<typename T>
+class FrameAllocator
+{
+public:
+	typedef T value_type;
+
+	FrameArena* m_Arena;
+
+	FrameAllocator() noexcept
+		: m_Arena(&FrameArena::Get()) {}
+	FrameAllocator(FrameArena& arena) noexcept
+		: m_Arena(&arena) {}
+	template<typename U>
+	FrameAllocator(const FrameAllocator<U>& other) noexcept
+		: m_Arena(other.m_Arena) {}
+
+	T* allocate(size_t count) { return m_Arena->Allocate<T>(count); }
+	void deallocate(T* pointer, size_t count) noexcept {}
+
+	template<typename U>
+	bool operator==(const FrameAllocator<U>& other) const { return m_Arena == other.m_Arena; }
+	template<typename U>
+	bool operator!=(const FrameAllocator<U>& other) const { return m_Arena != other.m_Arena; }
+};
+
+template<typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
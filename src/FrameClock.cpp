@@ -0,0 +1,138 @@
+#include "FrameClock.h"
+
+#include <algorithm>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#include <timeapi.h>
+#endif
+
+#include "imgui/imgui.h"
+
+FrameClock::FrameClock(float fixedTimestep)
+	: m_Start(Clock::now()), m_LastTick(m_Start), m_FrameCount(0), m_RawDeltaTime(0.0f), m_DeltaTime(0.0f),
+	m_TargetFrameRate(0.0f), m_SpinMargin(0.002f), m_SmoothingFrames(1), m_NextDelta(0), m_DeltaCount(0),
+	m_FixedTimestep(fixedTimestep), m_Accumulator(0.0f), m_MaxDeltaTime(0.25f),
+	m_MaxFixedSteps(8), m_FixedStepsThisFrame(0), m_FixedSteps(0), m_DroppedSteps(0)
+{
+#ifdef _WIN32
+	//Raises the scheduler resolution from 15.6ms so sleeps can be used for capping
+	timeBeginPeriod(1);
+#endif
+}
+
+FrameClock::~FrameClock()
+{
+#ifdef _WIN32
+	timeEndPeriod(1);
+#endif
+}
+
+void FrameClock::Tick()
+{
+	if (m_TargetFrameRate > 0.0f)
+		WaitForTarget();
+
+	Clock::time_point now = Clock::now();
+	m_RawDeltaTime = m_FrameCount ? std::chrono::duration<float>(now - m_LastTick).count() : 0.0f;
+	m_LastTick = now;
+	m_FrameCount++;
+
+	m_Deltas[m_NextDelta] = m_RawDeltaTime;
+	m_NextDelta = (m_NextDelta + 1) % MaxSmoothingFrames;
+	m_DeltaCount = std::min(m_DeltaCount + 1, MaxSmoothingFrames);
+
+	int count = std::min(m_SmoothingFrames, m_DeltaCount);
+	float total = 0.0f;
+	for (int i = 1; i <= count; i++)
+	{
+		total += m_Deltas[(m_NextDelta - i + MaxSmoothingFrames) % MaxSmoothingFrames];
+	}
+	m_DeltaTime = count ? total / count : 0.0f;
+
+	m_Accumulator += std::min(m_RawDeltaTime, m_MaxDeltaTime);
+	m_FixedStepsThisFrame = 0;
+}
+
+bool FrameClock::StepFixed()
+{
+	if (m_Accumulator < m_FixedTimestep)
+		return false;
+
+	//Drops the backlog instead of spiralling when updates are slower than real time
+	if (m_FixedStepsThisFrame == m_MaxFixedSteps)
+	{
+		int dropped = (int)(m_Accumulator / m_FixedTimestep);
+		m_DroppedSteps += dropped;
+		m_Accumulator -= dropped * m_FixedTimestep;
+		return false;
+	}
+
+	m_Accumulator -= m_FixedTimestep;
+	m_FixedStepsThisFrame++;
+	m_FixedSteps++;
+	return true;
+}
+
+void FrameClock::WaitForTarget()
+{
+	Clock::time_point target = m_LastTick + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(1.0f / m_TargetFrameRate));
+
+	Clock::time_point now = Clock::now();
+	float remaining = std::chrono::duration<float>(target - now).count();
+	if (remaining > m_SpinMargin)
+	{
+		std::this_thread::sleep_for(std::chrono::duration<float>(remaining - m_SpinMargin));
+	}
+
+	while (Clock::now() < target)
+	{
+		std::this_thread::yield();
+	}
+}
+
+void FrameClock::SetTargetFrameRate(float framesPerSecond)
+{
+	m_TargetFrameRate = std::max(framesPerSecond, 0.0f);
+}
+
+void FrameClock::SetFixedTimestep(float seconds)
+{
+	if (seconds > 0.0f)
+	{
+		m_FixedTimestep = seconds;
+	}
+}
+
+void FrameClock::SetSmoothingFrames(int frames)
+{
+	m_SmoothingFrames = std::max(1, std::min(frames, MaxSmoothingFrames));
+}
+
+double FrameClock::GetTime() const
+{
+	return std::chrono::duration<double>(Clock::now() - m_Start).count();
+}
+
+void FrameClock::OnImGuiRender()
+{
+	ImGui::Text("Frame %.3f ms (smoothed %.3f ms), %.1f FPS", m_RawDeltaTime * 1000.0f, m_DeltaTime * 1000.0f,
+		m_DeltaTime > 0.0f ? 1.0f / m_DeltaTime : 0.0f);
+
+	float targetFrameRate = m_TargetFrameRate;
+	if (ImGui::SliderFloat("Frame cap (0 = off)", &targetFrameRate, 0.0f, 480.0f, "%.0f"))
+		SetTargetFrameRate(targetFrameRate);
+
+	int smoothingFrames = m_SmoothingFrames;
+	if (ImGui::SliderInt("Smoothing frames", &smoothingFrames, 1, MaxSmoothingFrames))
+		SetSmoothingFrames(smoothingFrames);
+
+	float fixedRate = 1.0f / m_FixedTimestep;
+	if (ImGui::SliderFloat("Fixed update rate", &fixedRate, 10.0f, 240.0f, "%.0f Hz"))
+		SetFixedTimestep(1.0f / fixedRate);
+
+	ImGui::Text("Fixed steps this frame %d, total %llu, dropped %u", m_FixedStepsThisFrame, m_FixedSteps, m_DroppedSteps);
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <chrono>
+
+//Measures the time between frames, optionally caps the frame rate and
+//splits elapsed time into fixed simulation steps. Tick is called once at
+//the start of every frame, then StepFixed in a loop for the fixed updates:
+//
+//    clock.Tick();
+//    while (clock.StepFixed())
+//        test->OnFixedUpdate(clock.GetFixedTimestep());
+//    test->OnUpdate(clock.GetDeltaTime());
+class FrameClock
+{
+public:
+	static const int MaxSmoothingFrames = 32;
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	Clock::time_point m_Start, m_LastTick;
+	unsigned long long m_FrameCount;
+	float m_RawDeltaTime, m_DeltaTime;
+
+	//Frames are capped by sleeping until SpinMargin before the target
+	//and spinning the rest, since sleeps overshoot by up to a millisecond
+	float m_TargetFrameRate;
+	float m_SpinMargin;
+
+	float m_Deltas[MaxSmoothingFrames];
+	int m_SmoothingFrames, m_NextDelta, m_DeltaCount;
+
+	//Elapsed time is clamped to MaxDeltaTime so a stall (breakpoint, window
+	//drag) can't queue up more fixed steps than a frame can catch up on
+	float m_FixedTimestep, m_Accumulator, m_MaxDeltaTime;
+	int m_MaxFixedSteps, m_FixedStepsThisFrame;
+	unsigned long long m_FixedSteps;
+	unsigned int m_DroppedSteps;
+
+public:
+	FrameClock(float fixedTimestep = 1.0f / 60.0f);
+	~FrameClock();
+
+	void Tick();
+	bool StepFixed();
+
+	//0 runs uncapped
+	void SetTargetFrameRate(float framesPerSecond);
+	void SetFixedTimestep(float seconds);
+	//1 disables smoothing, up to MaxSmoothingFrames are averaged
+	void SetSmoothingFrames(int frames);
+
+	//Smoothed when smoothing is enabled, use GetRawDeltaTime for the measured one
+	inline float GetDeltaTime() const { return m_DeltaTime; }
+	inline float GetRawDeltaTime() const { return m_RawDeltaTime; }
+	inline float GetFixedTimestep() const { return m_FixedTimestep; }
+	//How far into the next fixed step the frame is, for interpolating rendering
+	inline float GetFixedAlpha() const { return m_Accumulator / m_FixedTimestep; }
+	inline float GetTargetFrameRate() const { return m_TargetFrameRate; }
+	inline int GetSmoothingFrames() const { return m_SmoothingFrames; }
+	inline int GetFixedStepsThisFrame() const { return m_FixedStepsThisFrame; }
+	inline unsigned int GetDroppedSteps() const { return m_DroppedSteps; }
+	inline unsigned long long GetFrameCount() const { return m_FrameCount; }
+	double GetTime() const;
+
+	void OnImGuiRender();
+
+private:
+	void WaitForTarget();
+};
@@ -0,0 +1,135 @@
+#include "GPUDeletionQueue.h"
+#include "Renderer.h"
+#include "MemoryTracker.h"
+
+GPUDeletionQueue::GPUDeletionQueue()
+	: m_Pending(), m_Frame(0), m_InFlight(0), m_Deleted(0), m_Deferred(true)
+{
+}
+
+GPUDeletionQueue& GPUDeletionQueue::Get()
+{
+	static GPUDeletionQueue instance;
+	return instance;
+}
+
+void GPUDeletionQueue::Release(GPUObjectType type, unsigned int rendererID)
+{
+	if (rendererID == 0)
+		return;
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (!m_Deferred && std::this_thread::get_id() == m_GLThread)
+	{
+		Batch batch = {};
+		batch.objects[(int)type].push_back(rendererID);
+		batch.count = 1;
+		Delete(batch);
+		return;
+	}
+
+	MEMORY_TAG(Rendering);
+	m_Pending.objects[(int)type].push_back(rendererID);
+	m_Pending.count++;
+}
+
+void GPUDeletionQueue::EndFrame()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_GLThread = std::this_thread::get_id();
+
+	if (m_Pending.count > 0)
+	{
+		MEMORY_TAG(Rendering);
+		m_Pending.frame = m_Frame;
+		m_Pending.fence = nullptr;
+		if (GLEW_ARB_sync || GLEW_VERSION_3_2)
+		{
+			m_Pending.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		}
+		m_InFlight += m_Pending.count;
+		m_Batches.push_back(std::move(m_Pending));
+		m_Pending = Batch();
+	}
+	m_Frame++;
+
+	//Batches are fenced in order, so the first one that isn't done yet
+	//means none of the later ones are either
+	while (!m_Batches.empty())
+	{
+		Batch& batch = m_Batches.front();
+		if (m_Frame - batch.frame < FrameDelay)
+			break;
+
+		if (batch.fence)
+		{
+			GLenum status = glClientWaitSync(batch.fence, 0, 0);
+			if (status == GL_TIMEOUT_EXPIRED)
+				break;
+			GLCall(glDeleteSync(batch.fence));
+		}
+
+		m_InFlight -= batch.count;
+		Delete(batch);
+		m_Batches.pop_front();
+	}
+}
+
+void GPUDeletionQueue::Flush()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	for (Batch& batch : m_Batches)
+	{
+		if (batch.fence)
+		{
+			GLCall(glDeleteSync(batch.fence));
+		}
+		Delete(batch);
+	}
+	m_Batches.clear();
+	m_InFlight = 0;
+
+	Delete(m_Pending);
+	m_Pending = Batch();
+}
+
+void GPUDeletionQueue::SetDeferred(bool deferred)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Deferred = deferred;
+}
+
+size_t GPUDeletionQueue::GetQueuedCount() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_Pending.count + m_InFlight;
+}
+
+void GPUDeletionQueue::Delete(Batch& batch)
+{
+	std::vector<unsigned int>& buffers = batch.objects[(int)GPUObjectType::Buffer];
+	if (!buffers.empty())
+	{
+		GLCall(glDeleteBuffers((GLsizei)buffers.size(), buffers.data()));
+	}
+
+	std::vector<unsigned int>& textures = batch.objects[(int)GPUObjectType::Texture];
+	if (!textures.empty())
+	{
+		GLCall(glDeleteTextures((GLsizei)textures.size(), textures.data()));
+	}
+
+	std::vector<unsigned int>& vertexArrays = batch.objects[(int)GPUObjectType::VertexArray];
+	if (!vertexArrays.empty())
+	{
+		GLCall(glDeleteVertexArrays((GLsizei)vertexArrays.size(), vertexArrays.data()));
+	}
+
+	for (unsigned int program : batch.objects[(int)GPUObjectType::Program])
+	{
+		GLCall(glDeleteProgram(program));
+	}
+
+	m_Deleted += batch.count;
+}
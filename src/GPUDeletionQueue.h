@@ -0,0 +1,64 @@
+#pragma once
+#include <GL/glew.h>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+enum class GPUObjectType {
+	Buffer, Texture, VertexArray, Program, Count
+};
+
+//Defers glDelete* calls until the GPU has finished with the objects. Everything
+//released during a frame is grouped behind a fence inserted at the end of that
+//frame, and deleted once FrameDelay frames have passed and the fence has
+//signalled, so releasing an object that is still in use never stalls.
+//Release can be called from any thread, the deletions happen in EndFrame
+//on the thread with the GL context. Together with GPUMemory and
+//TextureManager being locked, this means the wrappers themselves (buffers,
+//vertex arrays, shaders, textures) can be destroyed on any thread, not just
+//their raw names released
+class GPUDeletionQueue
+{
+public:
+	static const int FrameDelay = 2;
+
+private:
+	struct Batch {
+		std::vector<unsigned int> objects[(int)GPUObjectType::Count];
+		GLsync fence;
+		unsigned long long frame;
+		size_t count;
+	};
+
+	mutable std::mutex m_Mutex;
+	Batch m_Pending;
+	std::deque<Batch> m_Batches;
+	unsigned long long m_Frame;
+	size_t m_InFlight, m_Deleted;
+	bool m_Deferred;
+	//The thread that calls EndFrame, which has the GL context
+	std::thread::id m_GLThread;
+
+	GPUDeletionQueue();
+public:
+	static GPUDeletionQueue& Get();
+
+	//Name 0 is ignored, like glDelete* does
+	void Release(GPUObjectType type, unsigned int rendererID);
+
+	void EndFrame();
+	//Deletes everything immediately, call before the context is destroyed
+	void Flush();
+
+	//With deferral off objects released on the thread with the GL context are
+	//deleted straight away, those released on other threads are still queued
+	void SetDeferred(bool deferred);
+	inline bool IsDeferred() const { return m_Deferred; }
+
+	size_t GetQueuedCount() const;
+	inline size_t GetDeletedCount() const { return m_Deleted; }
+
+private:
+	void Delete(Batch& batch);
+};
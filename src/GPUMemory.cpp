@@ -0,0 +1,244 @@
+#include "GPUMemory.h"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+static thread_local const char* t_Site = nullptr;
+
+GPUMemorySite::GPUMemorySite(const char* site)
+	: m_Previous(t_Site)
+{
+	t_Site = site;
+}
+
+GPUMemorySite::~GPUMemorySite()
+{
+	t_Site = m_Previous;
+}
+
+const char* GPUMemorySite::GetCurrent()
+{
+	return t_Site;
+}
+
+GPUMemory::GPUMemory()
+	: m_CategoryBytes(), m_TotalBytes(0), m_PeakBytes(0), m_Start(std::chrono::steady_clock::now())
+{
+}
+
+GPUMemory& GPUMemory::Get()
+{
+	static GPUMemory gpuMemory;
+	return gpuMemory;
+}
+
+void GPUMemory::Track(GPUMemoryCategory category, const void* owner, unsigned int rendererID, size_t bytes, const std::string& name)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	auto it = m_Allocations.find(owner);
+	if (it == m_Allocations.end())
+	{
+		std::string site = t_Site ? t_Site : "";
+		if (!name.empty())
+			site += site.empty() ? name : " / " + name;
+
+		double created = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_Start).count();
+		it = m_Allocations.emplace(owner, GPUAllocation{ category, rendererID, 0, site, created }).first;
+	}
+
+	GPUAllocation& allocation = it->second;
+	m_CategoryBytes[(int)allocation.Category] -= allocation.Bytes;
+	m_TotalBytes -= allocation.Bytes;
+
+	allocation.Category = category;
+	allocation.RendererID = rendererID;
+	allocation.Bytes = bytes;
+
+	m_CategoryBytes[(int)category] += bytes;
+	m_TotalBytes += bytes;
+	m_PeakBytes = std::max(m_PeakBytes, m_TotalBytes);
+}
+
+void GPUMemory::Untrack(const void* owner)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	auto it = m_Allocations.find(owner);
+	if (it == m_Allocations.end())
+		return;
+
+	m_CategoryBytes[(int)it->second.Category] -= it->second.Bytes;
+	m_TotalBytes -= it->second.Bytes;
+	m_Allocations.erase(it);
+}
+
+void GPUMemory::Move(const void* from, const void* to)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	auto it = m_Allocations.find(from);
+	if (it == m_Allocations.end())
+		return;
+
+	GPUAllocation allocation = std::move(it->second);
+	m_Allocations.erase(it);
+	m_Allocations[to] = std::move(allocation);
+}
+
+size_t GPUMemory::GetCategoryBytes(GPUMemoryCategory category) const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_CategoryBytes[(int)category];
+}
+
+size_t GPUMemory::GetTotalBytes() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_TotalBytes;
+}
+
+size_t GPUMemory::GetPeakBytes() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_PeakBytes;
+}
+
+size_t GPUMemory::GetAllocationCount() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_Allocations.size();
+}
+
+std::vector<GPUAllocation> GPUMemory::GetAllocations() const
+{
+	std::vector<GPUAllocation> allocations;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		allocations.reserve(m_Allocations.size());
+		for (const auto& entry : m_Allocations)
+		{
+			allocations.push_back(entry.second);
+		}
+	}
+
+	std::sort(allocations.begin(), allocations.end(), [](const GPUAllocation& a, const GPUAllocation& b) {
+		return a.Bytes > b.Bytes;
+	});
+	return allocations;
+}
+
+const char* GPUMemory::GetCategoryName(GPUMemoryCategory category)
+{
+	switch (category)
+	{
+	case GPUMemoryCategory::VertexBuffers:	return "Vertex buffers";
+	case GPUMemoryCategory::IndexBuffers:	return "Index buffers";
+	case GPUMemoryCategory::UniformBuffers:	return "Uniform buffers";
+	case GPUMemoryCategory::Textures:		return "Textures";
+	default:								return "Unknown";
+	}
+}
+
+bool GPUMemory::QueryDriverMemory(DriverMemoryInfo& info)
+{
+	if (GLEW_NVX_gpu_memory_info)
+	{
+		info.Source = "GL_NVX_gpu_memory_info";
+		glGetIntegerv(GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX, &info.DedicatedKB);
+		glGetIntegerv(GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX, &info.TotalAvailableKB);
+		glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &info.CurrentAvailableKB);
+		glGetIntegerv(GL_GPU_MEMORY_INFO_EVICTED_MEMORY_NVX, &info.EvictedKB);
+		return true;
+	}
+
+	//Reports the free memory of each pool, the first value is the pool's total
+	if (GLEW_ATI_meminfo)
+	{
+		GLint texture[4], vbo[4];
+		info.Source = "GL_ATI_meminfo";
+		glGetIntegerv(GL_TEXTURE_FREE_MEMORY_ATI, texture);
+		glGetIntegerv(GL_VBO_FREE_MEMORY_ATI, vbo);
+		info.CurrentAvailableKB = std::min(texture[0], vbo[0]);
+		return true;
+	}
+
+	return false;
+}
+
+void GPUMemory::WriteJSON(std::ostream& stream) const
+{
+	size_t totalBytes, peakBytes, categoryBytes[(int)GPUMemoryCategory::Count];
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		totalBytes = m_TotalBytes;
+		peakBytes = m_PeakBytes;
+		std::copy(m_CategoryBytes, m_CategoryBytes + (int)GPUMemoryCategory::Count, categoryBytes);
+	}
+
+	stream << "{\"totalBytes\":" << totalBytes << ",\"peakBytes\":" << peakBytes << ",\"categories\":{";
+	for (int i = 0; i < (int)GPUMemoryCategory::Count; i++)
+	{
+		stream << (i ? "," : "") << "\"" << GetCategoryName((GPUMemoryCategory)i) << "\":" << categoryBytes[i];
+	}
+	stream << "}";
+
+	DriverMemoryInfo info;
+	if (QueryDriverMemory(info))
+	{
+		stream << ",\"driver\":{\"source\":\"" << info.Source
+			<< "\",\"dedicatedKB\":" << info.DedicatedKB
+			<< ",\"totalAvailableKB\":" << info.TotalAvailableKB
+			<< ",\"currentAvailableKB\":" << info.CurrentAvailableKB
+			<< ",\"evictedKB\":" << info.EvictedKB << "}";
+	}
+
+	stream << ",\"allocations\":[";
+	std::vector<GPUAllocation> allocations = GetAllocations();
+	for (size_t i = 0; i < allocations.size(); i++)
+	{
+		const GPUAllocation& allocation = allocations[i];
+		std::string site;
+		for (char c : allocation.Site)
+		{
+			if (c == '"' || c == '\\')
+				site += '\\';
+			site += c;
+		}
+
+		stream << (i ? "," : "") << "\n{\"category\":\"" << GetCategoryName(allocation.Category)
+			<< "\",\"id\":" << allocation.RendererID
+			<< ",\"bytes\":" << allocation.Bytes
+			<< ",\"site\":\"" << site
+			<< "\",\"createdSeconds\":" << allocation.CreatedSeconds << "}";
+	}
+	stream << "]}";
+}
+
+bool GPUMemory::Dump(const std::string& path) const
+{
+	std::ofstream stream(path);
+	if (!stream)
+	{
+		std::cout << "Warning: could not write " << path << std::endl;
+		return false;
+	}
+
+	WriteJSON(stream);
+	stream << std::endl;
+	return true;
+}
+
+void GPUMemory::ReportLeaks() const
+{
+	std::vector<GPUAllocation> allocations = GetAllocations();
+	if (allocations.empty())
+		return;
+
+	std::cout << "Warning: " << allocations.size() << " GL objects holding " << GetTotalBytes() << " bytes were never released" << std::endl;
+	for (const GPUAllocation& allocation : allocations)
+	{
+		std::cout << "    " << GetCategoryName(allocation.Category) << " " << allocation.RendererID << ", " << allocation.Bytes
+			<< " bytes, created at " << (allocation.Site.empty() ? "unknown site" : allocation.Site) << std::endl;
+	}
+}
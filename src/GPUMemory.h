@@ -0,0 +1,81 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum class GPUMemoryCategory {
+	VertexBuffers, IndexBuffers, UniformBuffers, Textures, Count
+};
+
+struct GPUAllocation {
+	GPUMemoryCategory Category;
+	unsigned int RendererID;
+	size_t Bytes;
+	std::string Site;
+	double CreatedSeconds;
+};
+
+//What the driver reports through GL_NVX_gpu_memory_info or GL_ATI_meminfo,
+//in kilobytes. Fields the extension doesn't provide are left at -1
+struct DriverMemoryInfo {
+	const char* Source = nullptr;
+	int DedicatedKB = -1;
+	int TotalAvailableKB = -1;
+	int CurrentAvailableKB = -1;
+	int EvictedKB = -1;
+};
+
+//Records the GPU storage of every buffer and texture, keyed by the wrapper
+//object that owns it so a texture that is recreated keeps a single entry.
+//Each allocation remembers where it was created: the site set by the
+//innermost GPUMemorySite scope, which TestMenu sets to the test's name, and
+//for textures the file. Locked, so wrappers can be destroyed on any thread
+class GPUMemory
+{
+private:
+	mutable std::mutex m_Mutex;
+	std::unordered_map<const void*, GPUAllocation> m_Allocations;
+	size_t m_CategoryBytes[(int)GPUMemoryCategory::Count];
+	size_t m_TotalBytes, m_PeakBytes;
+	std::chrono::steady_clock::time_point m_Start;
+
+	GPUMemory();
+public:
+	static GPUMemory& Get();
+
+	//Tracking an owner again replaces its entry but keeps the creation site and time
+	void Track(GPUMemoryCategory category, const void* owner, unsigned int rendererID, size_t bytes, const std::string& name = std::string());
+	void Untrack(const void* owner);
+	//Re-keys an entry when its owner is moved to a new address
+	void Move(const void* from, const void* to);
+
+	size_t GetCategoryBytes(GPUMemoryCategory category) const;
+	size_t GetTotalBytes() const;
+	size_t GetPeakBytes() const;
+	size_t GetAllocationCount() const;
+	//Largest first
+	std::vector<GPUAllocation> GetAllocations() const;
+
+	static const char* GetCategoryName(GPUMemoryCategory category);
+	static bool QueryDriverMemory(DriverMemoryInfo& info);
+
+	void WriteJSON(std::ostream& stream) const;
+	bool Dump(const std::string& path) const;
+	//Prints whatever is still allocated, call once everything should have been released
+	void ReportLeaks() const;
+};
+
+class GPUMemorySite
+{
+private:
+	const char* m_Previous;
+public:
+	GPUMemorySite(const char* site);
+	~GPUMemorySite();
+
+	static const char* GetCurrent();
+};
@@ -0,0 +1,159 @@
+#include "GPUProfiler.h"
+#include "Renderer.h"
+
+#include <algorithm>
+
+GPUProfiler::GPUProfiler()
+	: m_Enabled(false), m_Frame(0), m_DroppedFrames(0)
+{
+}
+
+GPUProfiler& GPUProfiler::Get()
+{
+	static GPUProfiler instance;
+	return instance;
+}
+
+void GPUProfiler::Init()
+{
+	m_Enabled = GLEW_ARB_timer_query || GLEW_VERSION_3_3;
+	if (!m_Enabled)
+		return;
+
+	for (Frame& frame : m_Frames)
+	{
+		frame.queries.resize(MaxScopesPerFrame * 2);
+		GLCall(glGenQueries((GLsizei)frame.queries.size(), frame.queries.data()));
+		frame.scopes.reserve(MaxScopesPerFrame);
+		frame.queriesUsed = 0;
+	}
+}
+
+void GPUProfiler::Shutdown()
+{
+	if (!m_Enabled)
+		return;
+
+	for (Frame& frame : m_Frames)
+	{
+		GLCall(glDeleteQueries((GLsizei)frame.queries.size(), frame.queries.data()));
+		frame.queries.clear();
+		frame.scopes.clear();
+	}
+	m_Enabled = false;
+}
+
+void GPUProfiler::BeginFrame()
+{
+	if (!m_Enabled)
+		return;
+
+	//This slot was last used FrameLatency frames ago
+	Frame& frame = m_Frames[m_Frame % FrameLatency];
+	CollectFrame(frame);
+	frame.scopes.clear();
+	frame.queriesUsed = 0;
+}
+
+void GPUProfiler::EndFrame()
+{
+	m_Frame++;
+}
+
+void GPUProfiler::CollectFrame(Frame& frame)
+{
+	if (frame.scopes.empty())
+		return;
+
+	//Queries complete in order, so if the last one is available they all are
+	GLint available = 0;
+	GLCall(glGetQueryObjectiv(frame.queries[frame.queriesUsed - 1], GL_QUERY_RESULT_AVAILABLE, &available));
+	if (!available)
+	{
+		m_DroppedFrames++;
+		return;
+	}
+
+	for (const Scope& scope : frame.scopes)
+	{
+		if (!scope.end)
+			continue;
+
+		GLuint64 begin, end;
+		GLCall(glGetQueryObjectui64v(scope.begin, GL_QUERY_RESULT, &begin));
+		GLCall(glGetQueryObjectui64v(scope.end, GL_QUERY_RESULT, &end));
+
+		History& history = m_History[scope.name];
+		history.last = (end - begin) / 1000000.0f;
+		history.samples[history.next % HistorySize] = history.last;
+		history.next++;
+	}
+}
+
+int GPUProfiler::BeginScope(const char* name)
+{
+	Frame& frame = m_Frames[m_Frame % FrameLatency];
+	if (!m_Enabled || (int)frame.scopes.size() >= MaxScopesPerFrame)
+		return -1;
+
+	auto it = m_NameIndices.find(name);
+	if (it == m_NameIndices.end())
+	{
+		it = m_NameIndices.emplace(name, (int)m_Names.size()).first;
+		m_Names.push_back(name);
+		m_History.push_back({ std::vector<float>(HistorySize), 0, 0.0f });
+	}
+
+	Scope scope;
+	scope.name = it->second;
+	scope.begin = frame.queries[frame.queriesUsed++];
+	scope.end = 0;
+	GLCall(glQueryCounter(scope.begin, GL_TIMESTAMP));
+
+	frame.scopes.push_back(scope);
+	return (int)frame.scopes.size() - 1;
+}
+
+void GPUProfiler::EndScope(int scope)
+{
+	if (scope < 0)
+		return;
+
+	Frame& frame = m_Frames[m_Frame % FrameLatency];
+	frame.scopes[scope].end = frame.queries[frame.queriesUsed++];
+	GLCall(glQueryCounter(frame.scopes[scope].end, GL_TIMESTAMP));
+}
+
+std::vector<GPUTimingStats> GPUProfiler::GetStats() const
+{
+	std::vector<GPUTimingStats> stats;
+	std::vector<float> samples;
+
+	for (size_t i = 0; i < m_Names.size(); i++)
+	{
+		const History& history = m_History[i];
+		int count = std::min(history.next, HistorySize);
+		if (count == 0)
+			continue;
+
+		samples.assign(history.samples.begin(), history.samples.begin() + count);
+
+		GPUTimingStats stat;
+		stat.Name = m_Names[i];
+		stat.LastMs = history.last;
+		stat.Samples = count;
+		stat.MinMs = *std::min_element(samples.begin(), samples.end());
+
+		float total = 0.0f;
+		for (float sample : samples)
+			total += sample;
+		stat.AvgMs = total / count;
+
+		auto p99 = samples.begin() + (count * 99) / 100;
+		std::nth_element(samples.begin(), p99, samples.end());
+		stat.P99Ms = *p99;
+
+		stats.push_back(stat);
+	}
+	return stats;
+}
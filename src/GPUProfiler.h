@@ -0,0 +1,86 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct GPUTimingStats {
+	std::string Name;
+	float LastMs;
+	float MinMs;
+	float AvgMs;
+	float P99Ms;
+	unsigned int Samples;
+};
+
+//Times named scopes on the GPU with pairs of GL_TIMESTAMP queries. Each frame
+//uses its own set of queries from a ring that is read back FrameLatency frames
+//later, by which point the GPU has finished with them, so timing never stalls
+//the pipeline. Results that still aren't ready are skipped rather than waited on
+class GPUProfiler
+{
+public:
+	static const int FrameLatency = 4;
+	static const int MaxScopesPerFrame = 64;
+	static const int HistorySize = 256;
+
+private:
+	struct Scope {
+		int name;
+		unsigned int begin, end;
+	};
+
+	struct Frame {
+		std::vector<unsigned int> queries;
+		std::vector<Scope> scopes;
+		int queriesUsed;
+	};
+
+	struct History {
+		std::vector<float> samples;
+		int next;
+		float last;
+	};
+
+	bool m_Enabled;
+	int m_Frame;
+	Frame m_Frames[FrameLatency];
+	std::unordered_map<std::string, int> m_NameIndices;
+	std::vector<std::string> m_Names;
+	std::vector<History> m_History;
+	unsigned int m_DroppedFrames;
+
+	GPUProfiler();
+public:
+	static GPUProfiler& Get();
+
+	//Both need a current GL context
+	void Init();
+	void Shutdown();
+
+	void BeginFrame();
+	void EndFrame();
+
+	int BeginScope(const char* name);
+	void EndScope(int scope);
+
+	std::vector<GPUTimingStats> GetStats() const;
+	inline unsigned int GetDroppedFrames() const { return m_DroppedFrames; }
+	inline bool IsEnabled() const { return m_Enabled; }
+
+private:
+	void CollectFrame(Frame& frame);
+};
+
+class GPUProfileScope
+{
+private:
+	int m_Scope;
+public:
+	GPUProfileScope(const char* name)
+		: m_Scope(GPUProfiler::Get().BeginScope(name)) {}
+	~GPUProfileScope() { GPUProfiler::Get().EndScope(m_Scope); }
+};
+
+#define GPU_PROFILE_CONCAT_IMPL(a, b) a##b
+#define GPU_PROFILE_CONCAT(a, b) GPU_PROFILE_CONCAT_IMPL(a, b)
+#define GPU_PROFILE_SCOPE(name) GPUProfileScope GPU_PROFILE_CONCAT(gpuProfileScope, __LINE__)(name)
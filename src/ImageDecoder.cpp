@@ -0,0 +1,37 @@
+#include "ImageDecoder.h"
+#include "PngImageDecoder.h"
+#include "stb_image/stb_image.h"
+
+static StbImageDecoder s_StbDecoder;
+static PngImageDecoder s_PngDecoder;
+static ImageDecoder* s_Decoder = &s_PngDecoder;
+
+ImageDecoder& ImageDecoder::Get()
+{
+	return *s_Decoder;
+}
+
+void ImageDecoder::Set(ImageDecoder& decoder)
+{
+	s_Decoder = &decoder;
+}
+
+const std::vector<ImageDecoder*>& ImageDecoder::GetAvailable()
+{
+	static std::vector<ImageDecoder*> decoders = { &s_StbDecoder, &s_PngDecoder };
+	return decoders;
+}
+
+unsigned char* StbImageDecoder::Decode(const unsigned char* data, size_t size, int& width, int& height, int& channels, int desiredChannels)
+{
+	stbi_set_flip_vertically_on_load_thread(1);
+	unsigned char* pixels = stbi_load_from_memory(data, (int)size, &width, &height, &channels, desiredChannels);
+	if (pixels && desiredChannels)
+		channels = desiredChannels;
+	return pixels;
+}
+
+void StbImageDecoder::Free(unsigned char* pixels)
+{
+	stbi_image_free(pixels);
+}
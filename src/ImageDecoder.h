@@ -0,0 +1,32 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+//Backend that turns an encoded image in memory into 8 bit pixels with the
+//bottom row first, the layout glTexImage2D expects. Implementations must
+//be safe to call from several threads at once. PngImageDecoder is used by
+//default, stb_image stays available to compare against
+class ImageDecoder
+{
+public:
+	virtual ~ImageDecoder() {}
+
+	virtual const char* GetName() const = 0;
+
+	//Passing 0 for desiredChannels keeps the image's own channel count
+	virtual unsigned char* Decode(const unsigned char* data, size_t size, int& width, int& height, int& channels, int desiredChannels) = 0;
+	virtual void Free(unsigned char* pixels) = 0;
+
+	static ImageDecoder& Get();
+	static void Set(ImageDecoder& decoder);
+	static const std::vector<ImageDecoder*>& GetAvailable();
+};
+
+class StbImageDecoder : public ImageDecoder
+{
+public:
+	const char* GetName() const override { return "stb_image"; }
+
+	unsigned char* Decode(const unsigned char* data, size_t size, int& width, int& height, int& channels, int desiredChannels) override;
+	void Free(unsigned char* pixels) override;
+};
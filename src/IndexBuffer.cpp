@@ -1,6 +1,13 @@
 #include "IndexBuffer.h"
 
 #include "Renderer.h"
+#include "GPUMemory.h"
+#include "GPUDeletionQueue.h"
+
+IndexBuffer::IndexBuffer()
+    : m_RendererID(0), m_Count(0)
+{
+}
 
 IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
     : m_Count(count)
@@ -10,11 +17,38 @@ IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
     GLCall(glGenBuffers(1, &m_RendererID));
     GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
     GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_STATIC_DRAW));
+    Renderer::GetStats().BytesUploaded += count * sizeof(unsigned int);
+    GPUMemory::Get().Track(GPUMemoryCategory::IndexBuffers, this, m_RendererID, count * sizeof(unsigned int));
 }
 
 IndexBuffer::~IndexBuffer()
 {
-    GLCall(glDeleteBuffers(1, &m_RendererID));
+    GPUMemory::Get().Untrack(this);
+    GPUDeletionQueue::Get().Release(GPUObjectType::Buffer, m_RendererID);
+}
+
+IndexBuffer::IndexBuffer(IndexBuffer&& other) noexcept
+    : m_RendererID(other.m_RendererID), m_Count(other.m_Count)
+{
+    other.m_RendererID = 0;
+    other.m_Count = 0;
+    GPUMemory::Get().Move(&other, this);
+}
+
+IndexBuffer& IndexBuffer::operator=(IndexBuffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        GPUMemory::Get().Untrack(this);
+        GPUDeletionQueue::Get().Release(GPUObjectType::Buffer, m_RendererID);
+
+        m_RendererID = other.m_RendererID;
+        m_Count = other.m_Count;
+        other.m_RendererID = 0;
+        other.m_Count = 0;
+        GPUMemory::Get().Move(&other, this);
+    }
+    return *this;
 }
 
 void IndexBuffer::Bind() const
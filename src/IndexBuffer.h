@@ -7,9 +7,15 @@ private:
 	unsigned int m_RendererID;
 	unsigned int m_Count;
 public:
+	IndexBuffer();
 	IndexBuffer(const unsigned int* data, unsigned int count);
 	~IndexBuffer();
 
+	IndexBuffer(const IndexBuffer&) = delete;
+	IndexBuffer& operator=(const IndexBuffer&) = delete;
+	IndexBuffer(IndexBuffer&& other) noexcept;
+	IndexBuffer& operator=(IndexBuffer&& other) noexcept;
+
 	void Bind() const;
 	void UnBind() const;
 
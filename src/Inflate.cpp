@@ -0,0 +1,409 @@
+#include "Inflate.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+static const unsigned MaxCodeBits = 15;
+static const unsigned LitLenTableBits = 10;
+static const unsigned DistTableBits = 8;
+static const unsigned CodeLengthTableBits = 7;
+
+static const unsigned LitLenSymbols = 288;
+static const unsigned DistSymbols = 32;
+static const unsigned CodeLengthSymbols = 19;
+
+//Room for the direct table and the worst case of one full subtable per long code
+static const size_t LitLenTableSize = (1 << LitLenTableBits) + LitLenSymbols * (1 << (MaxCodeBits - LitLenTableBits));
+static const size_t DistTableSize = (1 << DistTableBits) + DistSymbols * (1 << (MaxCodeBits - DistTableBits));
+
+//A table entry holds the symbol in the top 16 bits and the number of bits
+//its code takes in the bottom 8. Entries that point to a subtable hold its
+//offset and how many bits index it instead, with SubtableEntry set. Codes
+//that aren't in the tree decode to InvalidSymbol, which no caller accepts
+static const uint32_t SubtableEntry = 1 << 8;
+static const uint32_t InvalidSymbol = 0xFFFF;
+static const uint32_t InvalidEntry = InvalidSymbol << 16;
+
+static const uint16_t LengthBase[29] = {
+	3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+	35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t LengthExtra[29] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+	3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t DistBase[30] = {
+	1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+	257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+static const uint8_t DistExtra[30] = {
+	0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+	7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+static const uint8_t CodeLengthOrder[CodeLengthSymbols] = {
+	16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+//DEFLATE packs bits from the least significant end, so the buffer is filled
+//with whole little endian words while at least 8 bytes are left. A refill
+//always leaves at least 56 bits, enough for a length and distance pair with
+//their extra bits. Reading past the end yields zeros and counts them in
+//Overrun, so a stream that really used them can be rejected afterwards
+struct BitStream {
+	const unsigned char* Next;
+	const unsigned char* End;
+	uint64_t Bits;
+	unsigned Count;
+	size_t Overrun;
+
+	BitStream(const unsigned char* data, size_t size)
+		: Next(data), End(data + size), Bits(0), Count(0), Overrun(0)
+	{
+	}
+
+	inline void Refill()
+	{
+		if (End - Next >= 8)
+		{
+			//Bytes past the ones counted are loaded too, but they are the
+			//same bytes the next refill ORs into the same place
+			uint64_t word;
+			memcpy(&word, Next, sizeof(word));
+			Bits |= word << Count;
+			Next += (63 - Count) >> 3;
+			Count |= 56;
+		}
+		else
+		{
+			while (Count <= 56)
+			{
+				if (Next < End)
+					Bits |= (uint64_t)*Next++ << Count;
+				else
+					Overrun++;
+				Count += 8;
+			}
+		}
+	}
+
+	inline uint32_t Peek(unsigned count) const { return (uint32_t)(Bits & ((1ull << count) - 1)); }
+	inline void Consume(unsigned count) { Bits >>= count; Count -= count; }
+	inline uint32_t Read(unsigned count) { uint32_t value = Peek(count); Consume(count); return value; }
+
+	inline bool IsOverrun() const { return Overrun * 8 > Count; }
+};
+
+struct HuffmanTables {
+	uint32_t LitLen[LitLenTableSize];
+	uint32_t Dist[DistTableSize];
+};
+
+static inline uint32_t ReverseBits(uint32_t code, unsigned length)
+{
+	uint32_t reversed = 0;
+	for (unsigned i = 0; i < length; i++, code >>= 1)
+		reversed = (reversed << 1) | (code & 1);
+	return reversed;
+}
+
+//Builds the canonical Huffman code for lengths into table, which needs room
+//for tableSize entries. Incomplete codes are allowed, as DEFLATE uses them
+//for single distance codes, oversubscribed ones are rejected
+static bool BuildTable(const uint8_t* lengths, unsigned symbols, unsigned tableBits, uint32_t* table, size_t tableSize)
+{
+	unsigned lengthCounts[MaxCodeBits + 1] = {};
+	for (unsigned i = 0; i < symbols; i++)
+		lengthCounts[lengths[i]]++;
+	lengthCounts[0] = 0;
+
+	int left = 1;
+	for (unsigned length = 1; length <= MaxCodeBits; length++)
+	{
+		left = (left << 1) - (int)lengthCounts[length];
+		if (left < 0)
+			return false;
+	}
+
+	uint32_t nextCode[MaxCodeBits + 1];
+	uint32_t code = 0;
+	for (unsigned length = 1; length <= MaxCodeBits; length++)
+	{
+		code = (code + lengthCounts[length - 1]) << 1;
+		nextCode[length] = code;
+	}
+
+	const uint32_t tableMask = (1 << tableBits) - 1;
+	uint16_t codes[LitLenSymbols];
+	uint8_t subtableBits[1 << LitLenTableBits] = {};
+	for (unsigned i = 0; i < symbols; i++)
+	{
+		unsigned length = lengths[i];
+		if (!length)
+			continue;
+		codes[i] = (uint16_t)ReverseBits(nextCode[length]++, length);
+		if (length > tableBits)
+		{
+			uint8_t& bits = subtableBits[codes[i] & tableMask];
+			bits = std::max(bits, (uint8_t)(length - tableBits));
+		}
+	}
+
+	std::fill(table, table + ((size_t)1 << tableBits), InvalidEntry);
+	size_t used = (size_t)1 << tableBits;
+	for (uint32_t prefix = 0; prefix <= tableMask; prefix++)
+	{
+		if (!subtableBits[prefix])
+			continue;
+		size_t size = (size_t)1 << subtableBits[prefix];
+		if (used + size > tableSize)
+			return false;
+		table[prefix] = ((uint32_t)used << 16) | SubtableEntry | subtableBits[prefix];
+		std::fill(table + used, table + used + size, InvalidEntry);
+		used += size;
+	}
+
+	for (unsigned i = 0; i < symbols; i++)
+	{
+		unsigned length = lengths[i];
+		if (!length)
+			continue;
+		if (length <= tableBits)
+		{
+			for (uint32_t index = codes[i]; index <= tableMask; index += 1 << length)
+				table[index] = (i << 16) | length;
+		}
+		else
+		{
+			uint32_t subtable = table[codes[i] & tableMask];
+			uint32_t* entries = table + (subtable >> 16);
+			unsigned subtableLength = length - tableBits;
+			for (uint32_t index = codes[i] >> tableBits; index < (1u << (subtable & 0xFF)); index += 1 << subtableLength)
+				entries[index] = (i << 16) | subtableLength;
+		}
+	}
+	return true;
+}
+
+static inline uint32_t DecodeSymbol(BitStream& stream, const uint32_t* table, unsigned tableBits)
+{
+	uint32_t entry = table[stream.Peek(tableBits)];
+	if (entry & SubtableEntry)
+	{
+		stream.Consume(tableBits);
+		entry = table[(entry >> 16) + stream.Peek(entry & 0xFF)];
+	}
+	stream.Consume(entry & 0xFF);
+	return entry >> 16;
+}
+
+struct FixedTables : HuffmanTables {
+	FixedTables()
+	{
+		uint8_t lengths[LitLenSymbols];
+		std::fill(lengths, lengths + 144, (uint8_t)8);
+		std::fill(lengths + 144, lengths + 256, (uint8_t)9);
+		std::fill(lengths + 256, lengths + 280, (uint8_t)7);
+		std::fill(lengths + 280, lengths + 288, (uint8_t)8);
+		BuildTable(lengths, LitLenSymbols, LitLenTableBits, LitLen, LitLenTableSize);
+
+		std::fill(lengths, lengths + DistSymbols, (uint8_t)5);
+		BuildTable(lengths, DistSymbols, DistTableBits, Dist, DistTableSize);
+	}
+};
+
+static const HuffmanTables& GetFixedTables()
+{
+	static FixedTables tables;
+	return tables;
+}
+
+static bool ReadDynamicTables(BitStream& stream, HuffmanTables& tables)
+{
+	stream.Refill();
+	unsigned litLenCount = stream.Read(5) + 257;
+	unsigned distCount = stream.Read(5) + 1;
+	unsigned codeLengthCount = stream.Read(4) + 4;
+	if (litLenCount > 286 || distCount > 30)
+		return false;
+
+	uint8_t codeLengths[CodeLengthSymbols] = {};
+	for (unsigned i = 0; i < codeLengthCount; i++)
+	{
+		stream.Refill();
+		codeLengths[CodeLengthOrder[i]] = (uint8_t)stream.Read(3);
+	}
+	uint32_t codeLengthTable[1 << CodeLengthTableBits];
+	if (!BuildTable(codeLengths, CodeLengthSymbols, CodeLengthTableBits, codeLengthTable, 1 << CodeLengthTableBits))
+		return false;
+
+	//Both trees' lengths are one sequence, repeats can cross between them
+	uint8_t lengths[286 + 30];
+	unsigned total = litLenCount + distCount;
+	unsigned count = 0;
+	while (count < total)
+	{
+		stream.Refill();
+		uint32_t symbol = DecodeSymbol(stream, codeLengthTable, CodeLengthTableBits);
+		if (symbol < 16)
+		{
+			lengths[count++] = (uint8_t)symbol;
+			continue;
+		}
+
+		uint8_t value = 0;
+		unsigned repeat;
+		if (symbol == 16)
+		{
+			if (!count)
+				return false;
+			value = lengths[count - 1];
+			repeat = 3 + stream.Read(2);
+		}
+		else if (symbol == 17)
+			repeat = 3 + stream.Read(3);
+		else if (symbol == 18)
+			repeat = 11 + stream.Read(7);
+		else
+			return false;
+
+		if (repeat > total - count)
+			return false;
+		std::fill(lengths + count, lengths + count + repeat, value);
+		count += repeat;
+	}
+
+	//A block can't end without an end of block code
+	if (!lengths[256])
+		return false;
+	return BuildTable(lengths, litLenCount, LitLenTableBits, tables.LitLen, LitLenTableSize)
+		&& BuildTable(lengths + litLenCount, distCount, DistTableBits, tables.Dist, DistTableSize);
+}
+
+static bool DecodeBlock(BitStream& stream, const HuffmanTables& tables, unsigned char* out, size_t outSize, size_t& position)
+{
+	for (;;)
+	{
+		stream.Refill();
+		uint32_t symbol = DecodeSymbol(stream, tables.LitLen, LitLenTableBits);
+		if (symbol < 256)
+		{
+			if (position == outSize)
+				return false;
+			out[position++] = (unsigned char)symbol;
+			continue;
+		}
+		if (symbol == 256)
+			return true;
+
+		symbol -= 257;
+		if (symbol >= 29)
+			return false;
+		size_t length = LengthBase[symbol] + stream.Read(LengthExtra[symbol]);
+
+		symbol = DecodeSymbol(stream, tables.Dist, DistTableBits);
+		if (symbol >= 30)
+			return false;
+		size_t distance = DistBase[symbol] + stream.Read(DistExtra[symbol]);
+
+		if (distance > position || length > outSize - position)
+			return false;
+
+		unsigned char* dst = out + position;
+		const unsigned char* src = dst - distance;
+		position += length;
+		//Whole words can overlap the match as long as each one only reads
+		//bytes written before it, and may run up to 7 bytes past its end
+		if (distance >= 8 && outSize - position >= 8)
+		{
+			unsigned char* end = dst + length;
+			do
+			{
+				uint64_t word;
+				memcpy(&word, src, sizeof(word));
+				memcpy(dst, &word, sizeof(word));
+				src += 8;
+				dst += 8;
+			} while (dst < end);
+		}
+		else if (distance == 1)
+			memset(dst, *src, length);
+		else
+		{
+			for (size_t i = 0; i < length; i++)
+				dst[i] = src[i];
+		}
+	}
+}
+
+static bool CopyStoredBlock(BitStream& stream, unsigned char* out, size_t outSize, size_t& position)
+{
+	//Stored blocks start on a byte boundary, so the whole bytes still in
+	//the bit buffer are given back and the block is read directly
+	stream.Consume(stream.Count & 7);
+	size_t buffered = stream.Count / 8;
+	if (stream.Overrun > buffered)
+		return false;
+	stream.Next -= buffered - stream.Overrun;
+	stream.Bits = 0;
+	stream.Count = 0;
+	stream.Overrun = 0;
+
+	if (stream.End - stream.Next < 4)
+		return false;
+	size_t length = stream.Next[0] | (stream.Next[1] << 8);
+	size_t inverse = stream.Next[2] | (stream.Next[3] << 8);
+	stream.Next += 4;
+	if (length != (~inverse & 0xFFFF))
+		return false;
+	if ((size_t)(stream.End - stream.Next) < length || length > outSize - position)
+		return false;
+
+	memcpy(out + position, stream.Next, length);
+	stream.Next += length;
+	position += length;
+	return true;
+}
+
+bool Inflate::Decompress(const unsigned char* data, size_t size, unsigned char* out, size_t outSize, size_t& written)
+{
+	BitStream stream(data, size);
+	HuffmanTables dynamicTables;
+	size_t position = 0;
+
+	bool final;
+	do
+	{
+		stream.Refill();
+		final = stream.Read(1) != 0;
+		unsigned type = stream.Read(2);
+
+		bool result;
+		if (type == 0)
+			result = CopyStoredBlock(stream, out, outSize, position);
+		else if (type == 1)
+			result = DecodeBlock(stream, GetFixedTables(), out, outSize, position);
+		else if (type == 2)
+			result = ReadDynamicTables(stream, dynamicTables) && DecodeBlock(stream, dynamicTables, out, outSize, position);
+		else
+			result = false;
+
+		if (!result || stream.IsOverrun())
+			return false;
+	} while (!final);
+
+	written = position;
+	return true;
+}
+
+bool Inflate::DecompressZlib(const unsigned char* data, size_t size, unsigned char* out, size_t outSize, size_t& written)
+{
+	//Deflate with a window of at most 32KB and no preset dictionary
+	if (size < 2)
+		return false;
+	unsigned method = data[0] & 0x0F;
+	unsigned window = data[0] >> 4;
+	if (method != 8 || window > 7 || (data[1] & 0x20) || ((data[0] << 8) | data[1]) % 31)
+		return false;
+	return Decompress(data + 2, size - 2, out, outSize, written);
+}
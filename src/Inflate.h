@@ -0,0 +1,18 @@
+#pragma once
+#include <cstddef>
+
+//DEFLATE decoder for streams whose decompressed size is known up front, like
+//the image data of a PNG. Huffman codes are looked up with one table access
+//for short codes and a second for long ones, bits come from a 64 bit buffer
+//refilled a word at a time, and matches are copied 8 bytes at a time. Safe
+//to call from several threads at once
+class Inflate
+{
+public:
+	//Decompresses a raw DEFLATE stream into out, which is never written past
+	//outSize. Returns false if the stream is corrupt or doesn't fit, otherwise
+	//written holds the number of bytes produced
+	static bool Decompress(const unsigned char* data, size_t size, unsigned char* out, size_t outSize, size_t& written);
+	//The same for a stream with a zlib header, the checksum isn't verified
+	static bool DecompressZlib(const unsigned char* data, size_t size, unsigned char* out, size_t outSize, size_t& written);
+};
@@ -0,0 +1,314 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <string>
+
+#include "Profiler.h"
+#include "MemoryTracker.h"
+
+//Index of the calling thread's queue, -1 for threads outside the job system
+static thread_local int t_QueueIndex = -1;
+
+JobSystem::JobSystem()
+	: m_QueuedJobs(0), m_Sleeping(0), m_NextQueue(0), m_Quit(false), m_RunningMainThreadJobs(false)
+{
+}
+
+int JobSystem::GetThreadIndex()
+{
+	return t_QueueIndex;
+}
+
+JobSystem& JobSystem::Get()
+{
+	static JobSystem jobSystem;
+	return jobSystem;
+}
+
+void JobSystem::Queue::PushBack(Job job)
+{
+	if (count == jobs.size())
+	{
+		std::vector<Job> grown(jobs.size() * 2);
+		for (size_t i = 0; i < count; i++)
+		{
+			grown[i] = std::move(jobs[(head + i) % jobs.size()]);
+		}
+		jobs.swap(grown);
+		head = 0;
+	}
+	jobs[(head + count) % jobs.size()] = std::move(job);
+	count++;
+}
+
+void JobSystem::Queue::PopBack(Job& job)
+{
+	count--;
+	job = std::move(jobs[(head + count) % jobs.size()]);
+}
+
+void JobSystem::Queue::PopFront(Job& job)
+{
+	job = std::move(jobs[head]);
+	head = (head + 1) % jobs.size();
+	count--;
+}
+
+void JobSystem::Init(int workers)
+{
+	if (!m_Queues.empty())
+		return;
+
+	if (workers <= 0)
+		workers = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+
+	MEMORY_TAG(Jobs);
+	m_Quit = false;
+	for (int i = 0; i <= workers; i++)
+	{
+		m_Queues.push_back(std::make_unique<Queue>());
+	}
+
+	t_QueueIndex = 0;
+	for (int i = 1; i <= workers; i++)
+	{
+		m_Threads.emplace_back(&JobSystem::WorkerMain, this, i);
+	}
+}
+
+void JobSystem::Shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_SleepMutex);
+		m_Quit = true;
+	}
+	m_Wake.notify_all();
+
+	for (std::thread& thread : m_Threads)
+	{
+		thread.join();
+	}
+	m_Threads.clear();
+	m_Queues.clear();
+	m_QueuedJobs = 0;
+	t_QueueIndex = -1;
+}
+
+void JobSystem::Run(std::function<void()> function, JobCounter* counter, JobCounter* after)
+{
+	MEMORY_TAG(Jobs);
+	Job job = { std::move(function), counter };
+	if (counter)
+		counter->m_Count.fetch_add(1);
+
+	if (after)
+	{
+		std::lock_guard<std::mutex> lock(after->m_Mutex);
+		if (after->m_Count.load() > 0)
+		{
+			after->m_Continuations.push_back(std::move(job));
+			return;
+		}
+	}
+
+	if (m_Queues.empty())
+	{
+		Execute(job);
+		return;
+	}
+
+	Push(std::move(job));
+}
+
+void JobSystem::RunOnMainThread(std::function<void()> function, JobCounter* counter)
+{
+	MEMORY_TAG(Jobs);
+	if (counter)
+		counter->m_Count.fetch_add(1);
+
+	std::lock_guard<std::mutex> lock(m_MainThreadMutex);
+	m_MainThreadJobs.push_back({ std::move(function), counter });
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+	PROFILE_SCOPE("JobSystem::Wait");
+	while (!counter.IsDone())
+	{
+		if (t_QueueIndex == 0)
+			ProcessMainThreadJobs();
+
+		if (!TryRunJob())
+			std::this_thread::yield();
+	}
+}
+
+void JobSystem::ParallelFor(int count, int minBatchSize, const std::function<void(int, int)>& body)
+{
+	if (count <= 0)
+		return;
+
+	//A few ranges per thread evens out uneven work without paying
+	//for a job per element
+	int batches = std::min((count + std::max(minBatchSize, 1) - 1) / std::max(minBatchSize, 1), GetThreadCount() * 4);
+	if (batches <= 1)
+	{
+		body(0, count);
+		return;
+	}
+
+	JobCounter counter;
+	for (int i = 1; i < batches; i++)
+	{
+		int begin = (int)((long long)count * i / batches);
+		int end = (int)((long long)count * (i + 1) / batches);
+		Run([&body, begin, end]() { body(begin, end); }, &counter);
+	}
+	body(0, (int)((long long)count / batches));
+	Wait(counter);
+}
+
+void JobSystem::ProcessMainThreadJobs()
+{
+	if (m_RunningMainThreadJobs)
+		return;
+
+	//Swapped between two lists so both keep their capacity
+	m_RunningMainThreadJobs = true;
+	{
+		std::lock_guard<std::mutex> lock(m_MainThreadMutex);
+		m_MainThreadRunning.swap(m_MainThreadJobs);
+	}
+
+	for (Job& job : m_MainThreadRunning)
+	{
+		Execute(job);
+	}
+	m_MainThreadRunning.clear();
+	m_RunningMainThreadJobs = false;
+}
+
+void JobSystem::Push(Job job)
+{
+	int index = t_QueueIndex >= 0 ? t_QueueIndex : (int)(m_NextQueue++ % m_Queues.size());
+	Queue& queue = *m_Queues[index];
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.PushBack(std::move(job));
+	}
+
+	//Sleeping workers register before checking for work, so
+	//either they see this job or it sees them
+	m_QueuedJobs.fetch_add(1);
+	if (m_Sleeping.load() > 0)
+	{
+		std::lock_guard<std::mutex> lock(m_SleepMutex);
+		m_Wake.notify_one();
+	}
+}
+
+bool JobSystem::Pop(Job& job)
+{
+	if (m_QueuedJobs.load(std::memory_order_relaxed) == 0)
+		return false;
+
+	int own = t_QueueIndex;
+	if (own >= 0)
+	{
+		Queue& queue = *m_Queues[own];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.count)
+		{
+			queue.PopBack(job);
+			m_QueuedJobs.fetch_sub(1);
+			return true;
+		}
+	}
+
+	//Steals the oldest job, which for divide and conquer work is the largest
+	int count = (int)m_Queues.size();
+	int start = own >= 0 ? own + 1 : (int)(m_NextQueue.load(std::memory_order_relaxed) % count);
+	for (int i = 0; i < count; i++)
+	{
+		int victim = (start + i) % count;
+		if (victim == own)
+			continue;
+
+		Queue& queue = *m_Queues[victim];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.count)
+		{
+			queue.PopFront(job);
+			m_QueuedJobs.fetch_sub(1);
+			return true;
+		}
+	}
+	return false;
+}
+
+bool JobSystem::TryRunJob()
+{
+	Job job;
+	if (!Pop(job))
+		return false;
+
+	Execute(job);
+	return true;
+}
+
+void JobSystem::Execute(Job& job)
+{
+	job.function();
+	Finish(job.counter);
+}
+
+void JobSystem::Finish(JobCounter* counter)
+{
+	if (!counter)
+		return;
+
+	std::vector<Job> continuations;
+	counter->m_Finishing.fetch_add(1);
+	if (counter->m_Count.fetch_sub(1) == 1)
+	{
+		std::lock_guard<std::mutex> lock(counter->m_Mutex);
+		continuations.swap(counter->m_Continuations);
+	}
+
+	//Nothing touches the counter after this, so the continuations are
+	//only started once whoever owns it is free to destroy it
+	counter->m_Finishing.fetch_sub(1);
+
+	for (Job& job : continuations)
+	{
+		if (m_Queues.empty())
+			Execute(job);
+		else
+			Push(std::move(job));
+	}
+}
+
+void JobSystem::WorkerMain(int index)
+{
+	t_QueueIndex = index;
+	Profiler::Get().SetThreadName("Job Worker " + std::to_string(index));
+
+	while (!m_Quit.load(std::memory_order_relaxed))
+	{
+		if (TryRunJob())
+			continue;
+
+		//Spins briefly before sleeping since jobs tend to arrive in bursts
+		for (int i = 0; i < 64 && m_QueuedJobs.load(std::memory_order_relaxed) == 0; i++)
+		{
+			std::this_thread::yield();
+		}
+		if (m_QueuedJobs.load(std::memory_order_relaxed) > 0)
+			continue;
+
+		std::unique_lock<std::mutex> lock(m_SleepMutex);
+		m_Sleeping.fetch_add(1);
+		m_Wake.wait(lock, [this]() { return m_QueuedJobs.load() > 0 || m_Quit.load(); });
+		m_Sleeping.fetch_sub(1);
+	}
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobCounter;
+
+struct Job {
+	std::function<void()> function;
+	JobCounter* counter;
+};
+
+//Tracks a group of jobs. Starting a job with a counter increments it and
+//finishing the job decrements it, so waiting on the counter joins the group,
+//and jobs started to run after the counter only become runnable at zero
+class JobCounter
+{
+private:
+	friend class JobSystem;
+
+	//Finishing counts jobs that are still touching the counter after
+	//their work is done, so a waiter never frees it while it is in use
+	std::atomic<int> m_Count, m_Finishing;
+	std::mutex m_Mutex;
+	std::vector<Job> m_Continuations;
+
+public:
+	JobCounter() : m_Count(0), m_Finishing(0) {}
+
+	JobCounter(const JobCounter&) = delete;
+	JobCounter& operator=(const JobCounter&) = delete;
+
+	inline bool IsDone() const { return m_Count.load() == 0 && m_Finishing.load() == 0; }
+};
+
+//Runs jobs on a pool of worker threads plus whichever thread waits on them.
+//Every thread owns a deque it pushes and pops at the back, and when that is
+//empty it steals from the front of the others. Jobs that need the GL context
+//go through RunOnMainThread and run when the main loop processes them
+class JobSystem
+{
+private:
+	//Ring buffer of jobs that only grows, unlike a std::deque which
+	//allocates blocks as jobs come and go. The owner pushes and pops
+	//at the back, thieves take from the front
+	struct Queue {
+		std::mutex mutex;
+		std::vector<Job> jobs;
+		size_t head, count;
+
+		Queue() : jobs(256), head(0), count(0) {}
+
+		void PushBack(Job job);
+		void PopBack(Job& job);
+		void PopFront(Job& job);
+	};
+
+	//Queue 0 belongs to the thread that called Init, the rest to the workers
+	std::vector<std::unique_ptr<Queue>> m_Queues;
+	std::vector<std::thread> m_Threads;
+
+	std::atomic<int> m_QueuedJobs, m_Sleeping;
+	std::atomic<unsigned int> m_NextQueue;
+	std::atomic<bool> m_Quit;
+	std::mutex m_SleepMutex;
+	std::condition_variable m_Wake;
+
+	std::mutex m_MainThreadMutex;
+	std::vector<Job> m_MainThreadJobs, m_MainThreadRunning;
+	bool m_RunningMainThreadJobs;
+
+	JobSystem();
+public:
+	static JobSystem& Get();
+
+	//Called from the main thread, 0 workers means one per core besides it
+	void Init(int workers = 0);
+	//Jobs still queued are dropped
+	void Shutdown();
+
+	//Without Init jobs run immediately on the calling thread
+	void Run(std::function<void()> function, JobCounter* counter = nullptr, JobCounter* after = nullptr);
+	void RunOnMainThread(std::function<void()> function, JobCounter* counter = nullptr);
+
+	//Runs other jobs until the counter reaches zero
+	void Wait(JobCounter& counter);
+
+	//Splits [0, count) into ranges of at least minBatchSize and
+	//calls body(begin, end) for each in parallel, then waits
+	void ParallelFor(int count, int minBatchSize, const std::function<void(int, int)>& body);
+
+	//Called once per frame by the main loop. Main thread jobs started by a
+	//main thread job wait for the next call rather than running inside it
+	void ProcessMainThreadJobs();
+
+	//Workers plus the main thread
+	inline int GetThreadCount() const { return (int)m_Queues.size() + (m_Queues.empty() ? 1 : 0); }
+	//0 for the main thread, 1 and up for workers, -1 for threads outside the job system
+	static int GetThreadIndex();
+
+private:
+	void Push(Job job);
+	bool Pop(Job& job);
+	bool TryRunJob();
+	void Execute(Job& job);
+	void Finish(JobCounter* counter);
+	void WorkerMain(int index);
+};
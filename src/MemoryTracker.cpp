@@ -0,0 +1,310 @@
+#include "MemoryTracker.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <ostream>
+
+//Sits right before every block handed out, 16 bytes so the
+//block keeps the alignment malloc gives
+struct AllocationHeader {
+	uint64_t size;
+	uint32_t offset;
+	MemoryTag tag;
+	uint8_t padding[3];
+};
+static_assert(sizeof(AllocationHeader) == 16, "AllocationHeader must keep 16 byte alignment");
+
+struct TagCounters {
+	std::atomic<size_t> currentBytes;
+	std::atomic<size_t> peakBytes;
+	std::atomic<uint64_t> allocations;
+	std::atomic<uint64_t> frees;
+	uint64_t frameStart;
+	uint64_t lastFrameAllocations;
+};
+
+//Zero initialized before any constructor runs, so
+//allocations during static initialization are counted
+static TagCounters s_Tags[(int)MemoryTag::Count];
+static std::atomic<size_t> s_TotalBytes;
+static std::atomic<size_t> s_TotalPeakBytes;
+static std::atomic<uint64_t> s_Allocations;
+static uint64_t s_FrameStart;
+static uint64_t s_LastFrameAllocations;
+
+static thread_local MemoryTag t_Tag = MemoryTag::General;
+
+static void UpdatePeak(std::atomic<size_t>& peak, size_t value)
+{
+	size_t current = peak.load(std::memory_order_relaxed);
+	while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed))
+	{
+	}
+}
+
+void* MemoryTracker::Allocate(size_t size, size_t alignment)
+{
+	if (alignment < sizeof(AllocationHeader))
+		alignment = sizeof(AllocationHeader);
+
+	//malloc only guarantees max_align_t, anything beyond that
+	//needs room to slide the start forward
+	size_t extra = alignment > alignof(std::max_align_t) ? alignment - alignof(std::max_align_t) : 0;
+	unsigned char* base = (unsigned char*)malloc(size + sizeof(AllocationHeader) + extra);
+	if (!base)
+		return nullptr;
+
+	uintptr_t start = (uintptr_t)base + sizeof(AllocationHeader);
+	start = (start + alignment - 1) & ~(uintptr_t)(alignment - 1);
+
+	AllocationHeader* header = (AllocationHeader*)start - 1;
+	header->size = size;
+	header->offset = (uint32_t)(start - (uintptr_t)base);
+	header->tag = t_Tag;
+
+	TagCounters& counters = s_Tags[(int)t_Tag];
+	UpdatePeak(counters.peakBytes, counters.currentBytes.fetch_add(size, std::memory_order_relaxed) + size);
+	counters.allocations.fetch_add(1, std::memory_order_relaxed);
+	UpdatePeak(s_TotalPeakBytes, s_TotalBytes.fetch_add(size, std::memory_order_relaxed) + size);
+	s_Allocations.fetch_add(1, std::memory_order_relaxed);
+
+	return (void*)start;
+}
+
+void* MemoryTracker::Reallocate(void* pointer, size_t size)
+{
+	if (!pointer)
+		return Allocate(size);
+
+	void* resized = Allocate(size);
+	if (resized)
+	{
+		size_t oldSize = (size_t)((AllocationHeader*)pointer - 1)->size;
+		memcpy(resized, pointer, oldSize < size ? oldSize : size);
+		Free(pointer);
+	}
+	return resized;
+}
+
+void MemoryTracker::Free(void* pointer)
+{
+	if (!pointer)
+		return;
+
+	AllocationHeader* header = (AllocationHeader*)pointer - 1;
+	TagCounters& counters = s_Tags[(int)header->tag];
+	counters.currentBytes.fetch_sub((size_t)header->size, std::memory_order_relaxed);
+	counters.frees.fetch_add(1, std::memory_order_relaxed);
+	s_TotalBytes.fetch_sub((size_t)header->size, std::memory_order_relaxed);
+
+	free((unsigned char*)pointer - header->offset);
+}
+
+MemoryTag MemoryTracker::GetCurrentTag()
+{
+	return t_Tag;
+}
+
+MemoryTag MemoryTracker::SetCurrentTag(MemoryTag tag)
+{
+	MemoryTag previous = t_Tag;
+	t_Tag = tag;
+	return previous;
+}
+
+const char* MemoryTracker::GetTagName(MemoryTag tag)
+{
+	switch (tag)
+	{
+	case MemoryTag::General:	return "General";
+	case MemoryTag::Textures:	return "Textures";
+	case MemoryTag::Meshes:		return "Meshes";
+	case MemoryTag::Shaders:	return "Shaders";
+	case MemoryTag::Assets:		return "Assets";
+	case MemoryTag::Rendering:	return "Rendering";
+	case MemoryTag::Jobs:		return "Jobs";
+	case MemoryTag::UI:			return "UI";
+	default:					return "Unknown";
+	}
+}
+
+MemoryTagStats MemoryTracker::GetStats(MemoryTag tag)
+{
+	const TagCounters& counters = s_Tags[(int)tag];
+	MemoryTagStats stats;
+	stats.CurrentBytes = counters.currentBytes.load(std::memory_order_relaxed);
+	stats.PeakBytes = counters.peakBytes.load(std::memory_order_relaxed);
+	stats.Allocations = counters.allocations.load(std::memory_order_relaxed);
+	stats.Frees = counters.frees.load(std::memory_order_relaxed);
+	stats.LastFrameAllocations = counters.lastFrameAllocations;
+	return stats;
+}
+
+MemoryTagStats MemoryTracker::GetTotalStats()
+{
+	MemoryTagStats total = {};
+	for (int i = 0; i < (int)MemoryTag::Count; i++)
+	{
+		MemoryTagStats stats = GetStats((MemoryTag)i);
+		total.Allocations += stats.Allocations;
+		total.Frees += stats.Frees;
+	}
+	total.CurrentBytes = s_TotalBytes.load(std::memory_order_relaxed);
+	total.PeakBytes = s_TotalPeakBytes.load(std::memory_order_relaxed);
+	total.LastFrameAllocations = s_LastFrameAllocations;
+	return total;
+}
+
+uint64_t MemoryTracker::GetAllocationCount()
+{
+	return s_Allocations.load(std::memory_order_relaxed);
+}
+
+void MemoryTracker::NewFrame()
+{
+	for (TagCounters& counters : s_Tags)
+	{
+		uint64_t allocations = counters.allocations.load(std::memory_order_relaxed);
+		counters.lastFrameAllocations = allocations - counters.frameStart;
+		counters.frameStart = allocations;
+	}
+
+	uint64_t allocations = GetAllocationCount();
+	s_LastFrameAllocations = allocations - s_FrameStart;
+	s_FrameStart = allocations;
+}
+
+uint64_t MemoryTracker::GetLastFrameAllocations()
+{
+	return s_LastFrameAllocations;
+}
+
+static void WriteStatsJSON(std::ostream& stream, const MemoryTagStats& stats)
+{
+	stream << "\"currentBytes\":" << stats.CurrentBytes
+		<< ",\"peakBytes\":" << stats.PeakBytes
+		<< ",\"allocations\":" << stats.Allocations
+		<< ",\"frees\":" << stats.Frees
+		<< ",\"lastFrameAllocations\":" << stats.LastFrameAllocations;
+}
+
+void MemoryTracker::WriteJSON(std::ostream& stream)
+{
+	stream << "{";
+	WriteStatsJSON(stream, GetTotalStats());
+	stream << ",\"tags\":[";
+	for (int i = 0; i < (int)MemoryTag::Count; i++)
+	{
+		stream << (i ? "," : "") << "{\"name\":\"" << GetTagName((MemoryTag)i) << "\",";
+		WriteStatsJSON(stream, GetStats((MemoryTag)i));
+		stream << "}";
+	}
+	stream << "]}";
+}
+
+void* operator new(size_t size)
+{
+	if (void* pointer = MemoryTracker::Allocate(size))
+		return pointer;
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return MemoryTracker::Allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return MemoryTracker::Allocate(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	if (void* pointer = MemoryTracker::Allocate(size, (size_t)alignment))
+		return pointer;
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+	return operator new(size, alignment);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return MemoryTracker::Allocate(size, (size_t)alignment);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return MemoryTracker::Allocate(size, (size_t)alignment);
+}
+
+void operator delete(void* pointer) noexcept
+{
+	MemoryTracker::Free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+	MemoryTracker::Free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+	MemoryTracker::Free(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept
+{
+	MemoryTracker::Free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+	MemoryTracker::Free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{
+	MemoryTracker::Free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept
+{
+	MemoryTracker::Free(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept
+{
+	MemoryTracker::Free(pointer);
+}
+
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept
+{
+	MemoryTracker::Free(pointer);
+}
+
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept
+{
+	MemoryTracker::Free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	MemoryTracker::Free(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	MemoryTracker::Free(pointer);
+}
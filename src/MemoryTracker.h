@@ -0,0 +1,72 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+//What an allocation is charged to, taken from the allocating thread's
+//current tag. Keep GetTagName in sync when adding one
+enum class MemoryTag : uint8_t {
+	General, Textures, Meshes, Shaders, Assets, Rendering, Jobs, UI, Count
+};
+
+struct MemoryTagStats {
+	size_t CurrentBytes;
+	size_t PeakBytes;
+	uint64_t Allocations;
+	uint64_t Frees;
+	uint64_t LastFrameAllocations;
+};
+
+//Replaces the global operator new and delete to track heap memory per tag.
+//Every block carries a small header with its size and tag so frees are
+//charged back correctly, whichever thread or tag scope they happen in.
+//stb_image and ImGui are routed through Allocate and Free as well
+class MemoryTracker
+{
+public:
+	static void* Allocate(size_t size, size_t alignment = 16);
+	static void* Reallocate(void* pointer, size_t size);
+	static void Free(void* pointer);
+
+	static MemoryTag GetCurrentTag();
+	//Returns the tag it replaces
+	static MemoryTag SetCurrentTag(MemoryTag tag);
+	static const char* GetTagName(MemoryTag tag);
+
+	static MemoryTagStats GetStats(MemoryTag tag);
+	static MemoryTagStats GetTotalStats();
+	//Allocations made so far on any thread, for AllocationScope
+	static uint64_t GetAllocationCount();
+
+	//Called once per frame by the main loop
+	static void NewFrame();
+	static uint64_t GetLastFrameAllocations();
+
+	static void WriteJSON(std::ostream& stream);
+};
+
+class MemoryTagScope
+{
+private:
+	MemoryTag m_Previous;
+public:
+	MemoryTagScope(MemoryTag tag)
+		: m_Previous(MemoryTracker::SetCurrentTag(tag)) {}
+	~MemoryTagScope() { MemoryTracker::SetCurrentTag(m_Previous); }
+};
+
+#define MEMORY_TAG_CONCAT_IMPL(a, b) a##b
+#define MEMORY_TAG_CONCAT(a, b) MEMORY_TAG_CONCAT_IMPL(a, b)
+#define MEMORY_TAG(tag) MemoryTagScope MEMORY_TAG_CONCAT(memoryTagScope, __LINE__)(MemoryTag::tag)
+
+//Allocations made while the scope was open, on any thread
+class AllocationScope
+{
+private:
+	uint64_t m_Start;
+public:
+	AllocationScope()
+		: m_Start(MemoryTracker::GetAllocationCount()) {}
+
+	inline uint64_t GetAllocations() const { return MemoryTracker::GetAllocationCount() - m_Start; }
+};
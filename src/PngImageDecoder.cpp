@@ -0,0 +1,560 @@
+#include "PngImageDecoder.h"
+
+#include <climits>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "Inflate.h"
+#include "MemoryTracker.h"
+#include "SIMD.h"
+
+enum PngColorType {
+	Gray = 0, RGB = 2, Palette = 3, GrayAlpha = 4, RGBA = 6
+};
+
+enum PngFilter {
+	FilterNone = 0, FilterSub, FilterUp, FilterAverage, FilterPaeth
+};
+
+static const unsigned char PngSignature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+//What the chunks say about an image, with the IDAT chunks' data joined
+struct PngImage {
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+	int ColorType = 0;
+	//Bytes per pixel in the image data
+	int Samples = 0;
+	//Bytes per pixel decoded, counting the alpha a tRNS chunk adds
+	int Channels = 0;
+
+	bool Interlaced = false;
+
+	unsigned char Palette[256 * 4];
+	size_t PaletteSize = 0;
+	bool HasPaletteAlpha = false;
+	bool HasTransparentColor = false;
+	unsigned char TransparentColor[3] = {};
+
+	const unsigned char* Data = nullptr;
+	size_t DataSize = 0;
+	std::vector<unsigned char> JoinedData;
+};
+
+static inline uint32_t ReadBigEndian(const unsigned char* data)
+{
+	return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | data[3];
+}
+
+static inline bool IsChunk(const unsigned char* type, const char* name)
+{
+	return memcmp(type, name, 4) == 0;
+}
+
+//Returns false for anything this decoder leaves to stb_image
+static bool ParsePng(const unsigned char* data, size_t size, PngImage& image)
+{
+	if (size < sizeof(PngSignature) || memcmp(data, PngSignature, sizeof(PngSignature)) != 0)
+		return false;
+
+	std::vector<const unsigned char*> idat;
+	std::vector<size_t> idatSizes;
+	size_t position = sizeof(PngSignature);
+	bool first = true;
+	for (;;)
+	{
+		if (size - position < 12)
+			return false;
+		size_t length = ReadBigEndian(data + position);
+		const unsigned char* type = data + position + 4;
+		const unsigned char* chunk = type + 4;
+		if (length > size - position - 12)
+			return false;
+		position += length + 12;
+
+		if (first != IsChunk(type, "IHDR"))
+			return false;
+		first = false;
+
+		if (IsChunk(type, "IHDR"))
+		{
+			if (length != 13)
+				return false;
+			image.Width = ReadBigEndian(chunk);
+			image.Height = ReadBigEndian(chunk + 4);
+			int depth = chunk[8];
+			image.ColorType = chunk[9];
+			image.Interlaced = chunk[12] == 1;
+			if (depth != 8 || chunk[10] != 0 || chunk[11] != 0 || chunk[12] > 1)
+				return false;
+			if (!image.Width || !image.Height || image.Width > (1 << 24) || image.Height > (1 << 24))
+				return false;
+
+			switch (image.ColorType)
+			{
+			case Gray: image.Samples = 1; break;
+			case GrayAlpha: image.Samples = 2; break;
+			case RGB: image.Samples = 3; break;
+			case RGBA: image.Samples = 4; break;
+			case Palette: image.Samples = 1; break;
+			default: return false;
+			}
+		}
+		else if (IsChunk(type, "PLTE"))
+		{
+			if (length % 3 || length > 256 * 3)
+				return false;
+			//Indices past the end of the palette come out opaque black
+			for (size_t i = 0; i < 256; i++)
+			{
+				unsigned char* entry = image.Palette + i * 4;
+				bool inPalette = i < length / 3;
+				entry[0] = inPalette ? chunk[i * 3] : 0;
+				entry[1] = inPalette ? chunk[i * 3 + 1] : 0;
+				entry[2] = inPalette ? chunk[i * 3 + 2] : 0;
+				entry[3] = 255;
+			}
+			image.PaletteSize = length / 3;
+		}
+		else if (IsChunk(type, "tRNS"))
+		{
+			if (image.ColorType == Palette)
+			{
+				if (!image.PaletteSize || length > image.PaletteSize)
+					return false;
+				for (size_t i = 0; i < length; i++)
+					image.Palette[i * 4 + 3] = chunk[i];
+				image.HasPaletteAlpha = true;
+			}
+			else if (image.ColorType == Gray || image.ColorType == RGB)
+			{
+				//Samples are stored as 16 bits, the low byte holds an 8 bit one
+				size_t count = image.ColorType == Gray ? 1 : 3;
+				if (length != count * 2)
+					return false;
+				for (size_t i = 0; i < count; i++)
+					image.TransparentColor[i] = chunk[i * 2 + 1];
+				image.HasTransparentColor = true;
+			}
+			else
+				return false;
+		}
+		else if (IsChunk(type, "IDAT"))
+		{
+			idat.push_back(chunk);
+			idatSizes.push_back(length);
+		}
+		else if (IsChunk(type, "IEND"))
+			break;
+		else if (!(type[0] & 0x20))
+			//Critical chunks this decoder doesn't know
+			return false;
+	}
+
+	if (idat.empty() || (image.ColorType == Palette && !image.PaletteSize))
+		return false;
+
+	if (image.ColorType == Palette)
+		image.Channels = image.HasPaletteAlpha ? 4 : 3;
+	else
+		image.Channels = image.Samples + (image.HasTransparentColor ? 1 : 0);
+
+	//Most images have a single IDAT, which is decompressed where it is
+	if (idat.size() == 1)
+	{
+		image.Data = idat[0];
+		image.DataSize = idatSizes[0];
+	}
+	else
+	{
+		for (size_t i = 0; i < idat.size(); i++)
+			image.JoinedData.insert(image.JoinedData.end(), idat[i], idat[i] + idatSizes[i]);
+		image.Data = image.JoinedData.data();
+		image.DataSize = image.JoinedData.size();
+	}
+	return true;
+}
+
+static inline unsigned char PaethPredictor(int a, int b, int c)
+{
+	int pa = abs(b - c);
+	int pb = abs(a - c);
+	int pc = abs(a + b - 2 * c);
+	if (pa <= pb && pa <= pc)
+		return (unsigned char)a;
+	return (unsigned char)(pb <= pc ? b : c);
+}
+
+static void UnfilterScalar(int filter, unsigned char* row, const unsigned char* previous, size_t length, size_t bpp)
+{
+	switch (filter)
+	{
+	case FilterSub:
+		for (size_t i = bpp; i < length; i++)
+			row[i] += row[i - bpp];
+		break;
+	case FilterUp:
+		for (size_t i = 0; i < length; i++)
+			row[i] += previous[i];
+		break;
+	case FilterAverage:
+		for (size_t i = 0; i < bpp; i++)
+			row[i] += previous[i] >> 1;
+		for (size_t i = bpp; i < length; i++)
+			row[i] += (row[i - bpp] + previous[i]) >> 1;
+		break;
+	case FilterPaeth:
+		for (size_t i = 0; i < bpp; i++)
+			row[i] += previous[i];
+		for (size_t i = bpp; i < length; i++)
+			row[i] += PaethPredictor(row[i - bpp], previous[i], previous[i - bpp]);
+		break;
+	default:
+		break;
+	}
+}
+
+#ifdef SIMD_X86
+
+//Sub, Average and Paeth depend on the pixel to the left, so those work a
+//pixel at a time with the channels side by side, which only pays off for
+//3 and 4 bytes per pixel. 3 byte pixels are put together in a register
+//rather than copied through the stack, which would stall every load
+template<size_t Bpp>
+static inline __m128i LoadPixel(const unsigned char* pixel)
+{
+	uint32_t value;
+	if (Bpp == 4)
+		memcpy(&value, pixel, 4);
+	else
+	{
+		uint16_t low;
+		memcpy(&low, pixel, 2);
+		value = low | ((uint32_t)pixel[2] << 16);
+	}
+	return _mm_cvtsi32_si128((int)value);
+}
+
+template<size_t Bpp>
+static inline void StorePixel(unsigned char* pixel, __m128i value)
+{
+	uint32_t bytes = (uint32_t)_mm_cvtsi128_si32(value);
+	if (Bpp == 4)
+		memcpy(pixel, &bytes, 4);
+	else
+	{
+		uint16_t low = (uint16_t)bytes;
+		memcpy(pixel, &low, 2);
+		pixel[2] = (unsigned char)(bytes >> 16);
+	}
+}
+
+template<size_t Bpp>
+static void UnfilterSubSSE(unsigned char* row, size_t length)
+{
+	__m128i a = _mm_setzero_si128();
+	for (size_t i = 0; i < length; i += Bpp)
+	{
+		a = _mm_add_epi8(a, LoadPixel<Bpp>(row + i));
+		StorePixel<Bpp>(row + i, a);
+	}
+}
+
+static void UnfilterUpSSE(unsigned char* row, const unsigned char* previous, size_t length)
+{
+	size_t i = 0;
+	for (; i + 16 <= length; i += 16)
+	{
+		__m128i sum = _mm_add_epi8(_mm_loadu_si128((const __m128i*)(row + i)), _mm_loadu_si128((const __m128i*)(previous + i)));
+		_mm_storeu_si128((__m128i*)(row + i), sum);
+	}
+	for (; i < length; i++)
+		row[i] += previous[i];
+}
+
+template<size_t Bpp>
+static void UnfilterAverageSSE(unsigned char* row, const unsigned char* previous, size_t length)
+{
+	//_mm_avg_epu8 rounds up, taking 1 away where the sum is odd rounds down
+	const __m128i one = _mm_set1_epi8(1);
+	__m128i a = _mm_setzero_si128();
+	for (size_t i = 0; i < length; i += Bpp)
+	{
+		__m128i b = LoadPixel<Bpp>(previous + i);
+		__m128i average = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+		a = _mm_add_epi8(LoadPixel<Bpp>(row + i), average);
+		StorePixel<Bpp>(row + i, a);
+	}
+}
+
+static inline __m128i Select(__m128i mask, __m128i a, __m128i b)
+{
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+template<size_t Bpp>
+static void UnfilterPaethSSE(unsigned char* row, const unsigned char* previous, size_t length)
+{
+	//Widened to 16 bits, with p = a + b - c the distances are
+	//|p - a| = |b - c|, |p - b| = |a - c| and |p - c| = |a + b - 2c|
+	const __m128i zero = _mm_setzero_si128();
+	__m128i a = zero;
+	__m128i c = zero;
+	for (size_t i = 0; i < length; i += Bpp)
+	{
+		__m128i b = _mm_unpacklo_epi8(LoadPixel<Bpp>(previous + i), zero);
+		__m128i pa = _mm_sub_epi16(b, c);
+		__m128i pb = _mm_sub_epi16(a, c);
+		__m128i pc = _mm_add_epi16(pa, pb);
+		pa = _mm_max_epi16(pa, _mm_sub_epi16(zero, pa));
+		pb = _mm_max_epi16(pb, _mm_sub_epi16(zero, pb));
+		pc = _mm_max_epi16(pc, _mm_sub_epi16(zero, pc));
+
+		__m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+		__m128i predicted = Select(_mm_cmpeq_epi16(pa, smallest), a, Select(_mm_cmpeq_epi16(pb, smallest), b, c));
+
+		__m128i pixel = _mm_add_epi8(LoadPixel<Bpp>(row + i), _mm_packus_epi16(predicted, predicted));
+		StorePixel<Bpp>(row + i, pixel);
+		a = _mm_unpacklo_epi8(pixel, zero);
+		c = b;
+	}
+}
+
+//Returns false for the rows UnfilterScalar has to handle
+static bool UnfilterSSE(int filter, unsigned char* row, const unsigned char* previous, size_t length, size_t bpp)
+{
+	if (filter == FilterUp)
+	{
+		UnfilterUpSSE(row, previous, length);
+		return true;
+	}
+	if (bpp < 3)
+		return false;
+
+	switch (filter)
+	{
+	case FilterSub:
+		bpp == 3 ? UnfilterSubSSE<3>(row, length) : UnfilterSubSSE<4>(row, length);
+		return true;
+	case FilterAverage:
+		bpp == 3 ? UnfilterAverageSSE<3>(row, previous, length) : UnfilterAverageSSE<4>(row, previous, length);
+		return true;
+	case FilterPaeth:
+		bpp == 3 ? UnfilterPaethSSE<3>(row, previous, length) : UnfilterPaethSSE<4>(row, previous, length);
+		return true;
+	default:
+		return false;
+	}
+}
+
+#endif
+
+//Writes a row out with the channels asked for, converting the way
+//stb_image does, including its luma weights for grayscale
+static void ConvertRow(const PngImage& image, const unsigned char* source, uint32_t width, unsigned char* destination, int channels)
+{
+	for (uint32_t x = 0; x < width; x++)
+	{
+		unsigned char r, g, b, a = 255;
+		switch (image.ColorType)
+		{
+		case Gray:
+			r = g = b = source[x];
+			if (image.HasTransparentColor && r == image.TransparentColor[0])
+				a = 0;
+			break;
+		case GrayAlpha:
+			r = g = b = source[x * 2];
+			a = source[x * 2 + 1];
+			break;
+		case RGB:
+			r = source[x * 3];
+			g = source[x * 3 + 1];
+			b = source[x * 3 + 2];
+			if (image.HasTransparentColor && r == image.TransparentColor[0] && g == image.TransparentColor[1] && b == image.TransparentColor[2])
+				a = 0;
+			break;
+		case Palette:
+		{
+			const unsigned char* entry = image.Palette + source[x] * 4;
+			r = entry[0];
+			g = entry[1];
+			b = entry[2];
+			a = entry[3];
+			break;
+		}
+		default:
+			r = source[x * 4];
+			g = source[x * 4 + 1];
+			b = source[x * 4 + 2];
+			a = source[x * 4 + 3];
+			break;
+		}
+
+		unsigned char* pixel = destination + (size_t)x * channels;
+		switch (channels)
+		{
+		case 1:
+			pixel[0] = (unsigned char)((r * 77 + g * 150 + b * 29) >> 8);
+			break;
+		case 2:
+			pixel[0] = (unsigned char)((r * 77 + g * 150 + b * 29) >> 8);
+			pixel[1] = a;
+			break;
+		case 3:
+			pixel[0] = r;
+			pixel[1] = g;
+			pixel[2] = b;
+			break;
+		default:
+			pixel[0] = r;
+			pixel[1] = g;
+			pixel[2] = b;
+			pixel[3] = a;
+			break;
+		}
+	}
+}
+
+//The pixels one pass of the image data covers. Interlaced images are
+//stored as 7 smaller images, each filtered on its own
+struct PngPass {
+	uint32_t X, Y;
+	uint32_t StepX, StepY;
+	uint32_t Width, Height;
+};
+
+static size_t GetPasses(const PngImage& image, PngPass* passes)
+{
+	if (!image.Interlaced)
+	{
+		passes[0] = { 0, 0, 1, 1, image.Width, image.Height };
+		return 1;
+	}
+
+	static const uint32_t Adam7[7][4] = {
+		{ 0, 0, 8, 8 }, { 4, 0, 8, 8 }, { 0, 4, 4, 8 }, { 2, 0, 4, 4 },
+		{ 0, 2, 2, 4 }, { 1, 0, 2, 2 }, { 0, 1, 1, 2 }
+	};
+	size_t count = 0;
+	for (const uint32_t* pass : Adam7)
+	{
+		uint32_t width = image.Width > pass[0] ? (image.Width - pass[0] + pass[2] - 1) / pass[2] : 0;
+		uint32_t height = image.Height > pass[1] ? (image.Height - pass[1] + pass[3] - 1) / pass[3] : 0;
+		//Empty passes have no rows, not even filter bytes
+		if (width && height)
+			passes[count++] = { pass[0], pass[1], pass[2], pass[3], width, height };
+	}
+	return count;
+}
+
+unsigned char* PngImageDecoder::DecodeFallback(const unsigned char* data, size_t size, int& width, int& height, int& channels, int desiredChannels)
+{
+	unsigned char* pixels = m_Fallback.Decode(data, size, width, height, channels, desiredChannels);
+	if (pixels)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_FallbackImages.insert(pixels);
+	}
+	return pixels;
+}
+
+unsigned char* PngImageDecoder::Decode(const unsigned char* data, size_t size, int& width, int& height, int& channels, int desiredChannels)
+{
+	PngImage image;
+	if (!ParsePng(data, size, image) || desiredChannels < 0 || desiredChannels > 4)
+		return DecodeFallback(data, size, width, height, channels, desiredChannels);
+
+	PngPass passes[7];
+	size_t passCount = GetPasses(image, passes);
+	//Every row starts with the byte naming its filter
+	uint64_t filteredSize = 0;
+	for (size_t i = 0; i < passCount; i++)
+		filteredSize += (uint64_t)passes[i].Height * ((uint64_t)passes[i].Width * image.Samples + 1);
+
+	int outputChannels = desiredChannels ? desiredChannels : image.Channels;
+	size_t outputStride = (size_t)image.Width * outputChannels;
+	//The same limit as stb_image, so both accept the same images
+	if (filteredSize > INT_MAX || (uint64_t)image.Height * outputStride > INT_MAX)
+		return DecodeFallback(data, size, width, height, channels, desiredChannels);
+
+	std::vector<unsigned char> filtered((size_t)filteredSize);
+	size_t written;
+	if (!Inflate::DecompressZlib(image.Data, image.DataSize, filtered.data(), filtered.size(), written) || written != filtered.size())
+		return DecodeFallback(data, size, width, height, channels, desiredChannels);
+
+	unsigned char* pixels = (unsigned char*)MemoryTracker::Allocate(image.Height * outputStride);
+	if (!pixels)
+		return nullptr;
+
+#ifdef SIMD_X86
+	bool simd = SIMD::GetLevel() >= SIMDLevel::SSE;
+#endif
+	//Palettes and tRNS colors always need converting, otherwise only a different channel count does
+	bool copyRows = outputChannels == image.Samples && image.Channels == image.Samples;
+	std::vector<unsigned char> zeroRow((size_t)image.Width * image.Samples, 0);
+	//Rows of the interlaced passes are converted here, then spread out
+	std::vector<unsigned char> passRow(image.Interlaced ? outputStride : 0);
+
+	unsigned char* row = filtered.data();
+	for (size_t i = 0; i < passCount; i++)
+	{
+		const PngPass& pass = passes[i];
+		size_t stride = (size_t)pass.Width * image.Samples;
+		const unsigned char* previous = zeroRow.data();
+		for (uint32_t y = 0; y < pass.Height; y++)
+		{
+			int filter = *row++;
+			if (filter > FilterPaeth)
+			{
+				MemoryTracker::Free(pixels);
+				return DecodeFallback(data, size, width, height, channels, desiredChannels);
+			}
+
+			bool unfiltered = false;
+#ifdef SIMD_X86
+			if (simd && filter != FilterNone)
+				unfiltered = UnfilterSSE(filter, row, previous, stride, image.Samples);
+#endif
+			if (!unfiltered)
+				UnfilterScalar(filter, row, previous, stride, image.Samples);
+
+			//PNGs store the top row first
+			unsigned char* destination = pixels + (image.Height - 1 - (pass.Y + y * pass.StepY)) * outputStride;
+			unsigned char* converted = pass.StepX == 1 ? destination : passRow.data();
+			if (copyRows)
+				memcpy(converted, row, stride);
+			else
+				ConvertRow(image, row, pass.Width, converted, outputChannels);
+			if (pass.StepX != 1)
+			{
+				for (uint32_t x = 0; x < pass.Width; x++)
+					memcpy(destination + (size_t)(pass.X + x * pass.StepX) * outputChannels, passRow.data() + (size_t)x * outputChannels, outputChannels);
+			}
+
+			previous = row;
+			row += stride;
+		}
+	}
+
+	width = (int)image.Width;
+	height = (int)image.Height;
+	channels = outputChannels;
+	return pixels;
+}
+
+void PngImageDecoder::Free(unsigned char* pixels)
+{
+	bool fallback;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		fallback = m_FallbackImages.erase(pixels) != 0;
+	}
+
+	if (fallback)
+		m_Fallback.Free(pixels);
+	else
+		MemoryTracker::Free(pixels);
+}
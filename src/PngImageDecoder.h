@@ -0,0 +1,25 @@
+#pragma once
+#include <mutex>
+#include <unordered_set>
+
+#include "ImageDecoder.h"
+
+//Decodes 8 bit PNGs with Inflate and unfilters rows with SSE2 for
+//SIMD::GetLevel, producing the same pixels as stb_image. Other bit depths,
+//anything that isn't a PNG and anything it finds corrupt are handed to
+//stb_image, which also reports their errors
+class PngImageDecoder : public ImageDecoder
+{
+private:
+	StbImageDecoder m_Fallback;
+	//Images decoded by the fallback, which have to be freed by it too
+	std::unordered_set<unsigned char*> m_FallbackImages;
+	std::mutex m_Mutex;
+
+	unsigned char* DecodeFallback(const unsigned char* data, size_t size, int& width, int& height, int& channels, int desiredChannels);
+public:
+	const char* GetName() const override { return "png (SIMD unfilter)"; }
+
+	unsigned char* Decode(const unsigned char* data, size_t size, int& width, int& height, int& channels, int desiredChannels) override;
+	void Free(unsigned char* pixels) override;
+};
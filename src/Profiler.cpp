@@ -0,0 +1,87 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+Profiler::Profiler()
+	: m_StartTicks(Now()), m_StartTime(std::chrono::steady_clock::now())
+{
+}
+
+Profiler& Profiler::Get()
+{
+	static Profiler instance;
+	return instance;
+}
+
+Profiler::ThreadBuffer* Profiler::CreateThreadBuffer()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	std::unique_ptr<ThreadBuffer> buffer = std::make_unique<ThreadBuffer>();
+	buffer->events.resize(EventsPerThread);
+	buffer->count = 0;
+	buffer->threadID = (uint32_t)m_Threads.size() + 1;
+	buffer->threadName = "Thread " + std::to_string(buffer->threadID);
+
+	m_Threads.push_back(std::move(buffer));
+	return m_Threads.back().get();
+}
+
+void Profiler::SetThreadName(const std::string& name)
+{
+	ThreadBuffer* buffer = GetThreadBuffer();
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	buffer->threadName = name;
+}
+
+bool Profiler::WriteChromeTrace(const std::string& path)
+{
+	std::ofstream stream(path, std::ios::trunc);
+	if (!stream)
+	{
+		std::cout << "Failed to create '" << path << "'" << std::endl;
+		return false;
+	}
+
+	//Timestamp ticks are converted with the rate measured since startup
+	double elapsedUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - m_StartTime).count();
+	double ticksPerUs = std::max(1.0, (Now() - m_StartTicks) / std::max(elapsedUs, 1.0));
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+	bool first = true;
+	for (auto& buffer : m_Threads)
+	{
+		stream << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadID
+			<< ",\"args\":{\"name\":\"" << buffer->threadName << "\"}}";
+		first = false;
+
+		uint32_t count = buffer->count.load(std::memory_order_acquire);
+		uint32_t begin = count > EventsPerThread ? count - EventsPerThread : 0;
+		for (uint32_t i = begin; i < count; i++)
+		{
+			const Event& event = buffer->events[i % EventsPerThread];
+			if (event.start < m_StartTicks)
+				continue;
+
+			stream << ",\n{\"name\":\"";
+			for (const char* c = event.name; *c; c++)
+			{
+				if (*c == '"' || *c == '\\')
+					stream << '\\';
+				stream << *c;
+			}
+			stream << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadID
+				<< ",\"ts\":" << (event.start - m_StartTicks) / ticksPerUs
+				<< ",\"dur\":" << (event.end - event.start) / ticksPerUs << "}";
+		}
+	}
+
+	stream << "\n]}\n";
+	std::cout << "Wrote profile trace to '" << path << "'" << std::endl;
+	return (bool)stream;
+}
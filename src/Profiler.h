@@ -0,0 +1,94 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define PROFILER_USE_TSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PROFILER_USE_TSC
+#endif
+
+//CPU instrumentation cheap enough to leave on: a zone is two timestamp reads
+//and one store into a ring buffer owned by the calling thread, so nothing is
+//shared or locked while recording. The most recent events of every thread can
+//be exported as Chrome trace JSON, which Perfetto and chrome://tracing open
+class Profiler
+{
+public:
+	struct Event {
+		const char* name;
+		uint64_t start;
+		uint64_t end;
+	};
+
+	static const uint32_t EventsPerThread = 1 << 16;
+
+private:
+	struct ThreadBuffer {
+		std::vector<Event> events;
+		std::atomic<uint32_t> count;
+		uint32_t threadID;
+		std::string threadName;
+	};
+
+	std::mutex m_Mutex;
+	std::vector<std::unique_ptr<ThreadBuffer>> m_Threads;
+	uint64_t m_StartTicks;
+	std::chrono::steady_clock::time_point m_StartTime;
+
+	Profiler();
+	ThreadBuffer* CreateThreadBuffer();
+
+	inline ThreadBuffer* GetThreadBuffer()
+	{
+		thread_local ThreadBuffer* buffer = CreateThreadBuffer();
+		return buffer;
+	}
+public:
+	static Profiler& Get();
+
+	static inline uint64_t Now()
+	{
+#ifdef PROFILER_USE_TSC
+		return __rdtsc();
+#else
+		return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+	}
+
+	inline void Record(const char* name, uint64_t start, uint64_t end)
+	{
+		ThreadBuffer* buffer = GetThreadBuffer();
+		uint32_t index = buffer->count.load(std::memory_order_relaxed);
+		buffer->events[index % EventsPerThread] = { name, start, end };
+		buffer->count.store(index + 1, std::memory_order_release);
+	}
+
+	void SetThreadName(const std::string& name);
+
+	//Events still being recorded while this runs may be skipped or torn
+	bool WriteChromeTrace(const std::string& path);
+};
+
+class ProfileScope
+{
+private:
+	const char* m_Name;
+	uint64_t m_Start;
+public:
+	ProfileScope(const char* name)
+		: m_Name(name), m_Start(Profiler::Now()) {}
+	~ProfileScope() { Profiler::Get().Record(m_Name, m_Start, Profiler::Now()); }
+};
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCTION__)
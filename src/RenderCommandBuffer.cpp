@@ -0,0 +1,210 @@
+#include "RenderCommandBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Renderer.h"
+#include "Texture.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "FrameArena.h"
+#include "MemoryTracker.h"
+
+void RenderCommandBuffer::Reset()
+{
+	m_Commands.clear();
+	m_Uniforms.clear();
+}
+
+void RenderCommandBuffer::Draw(uint64_t sortKey, const VertexArray& va, const IndexBuffer& ib, Shader& shader, const Texture* texture)
+{
+	MEMORY_TAG(Rendering);
+	m_Commands.push_back({ sortKey, &va, &ib, &shader, texture, (uint32_t)m_Uniforms.size(), 0 });
+}
+
+void RenderCommandBuffer::SetUniform1i(int location, int value)
+{
+	PushUniform(location, UniformType::Int, &value, sizeof(value));
+}
+
+void RenderCommandBuffer::SetUniform1f(int location, float value)
+{
+	PushUniform(location, UniformType::Float, &value, sizeof(value));
+}
+
+void RenderCommandBuffer::SetUniform4f(int location, const glm::vec4& value)
+{
+	PushUniform(location, UniformType::Vec4, &value[0], sizeof(float) * 4);
+}
+
+void RenderCommandBuffer::SetUniformMat4f(int location, const glm::mat4& matrix)
+{
+	PushUniform(location, UniformType::Mat4, &matrix[0][0], sizeof(float) * 16);
+}
+
+void RenderCommandBuffer::PushUniform(int location, UniformType type, const void* data, size_t size)
+{
+	ASSERT(!m_Commands.empty());
+	MEMORY_TAG(Rendering);
+
+	UniformHeader header = { location, type };
+	size_t offset = m_Uniforms.size();
+	m_Uniforms.resize(offset + sizeof(header) + size);
+	memcpy(&m_Uniforms[offset], &header, sizeof(header));
+	memcpy(&m_Uniforms[offset + sizeof(header)], data, size);
+
+	m_Commands.back().uniformCount++;
+}
+
+void RenderCommandBuffer::ApplyUniforms(const RenderCommand& command) const
+{
+	const unsigned char* data = m_Uniforms.data() + command.uniformOffset;
+	for (uint32_t i = 0; i < command.uniformCount; i++)
+	{
+		UniformHeader header;
+		memcpy(&header, data, sizeof(header));
+		data += sizeof(header);
+
+		//Copied out since values are packed back to back after 8 byte
+		//headers, with no alignment beyond that of the byte array
+		switch (header.type)
+		{
+		case UniformType::Int:
+		{
+			int value;
+			memcpy(&value, data, sizeof(value));
+			command.shader->SetUniform1i(header.location, value);
+			data += sizeof(value);
+			break;
+		}
+		case UniformType::Float:
+		{
+			float value;
+			memcpy(&value, data, sizeof(value));
+			command.shader->SetUniform1f(header.location, value);
+			data += sizeof(value);
+			break;
+		}
+		case UniformType::Vec4:
+		{
+			glm::vec4 value;
+			memcpy(&value[0], data, sizeof(float) * 4);
+			command.shader->SetUniform4f(header.location, value.x, value.y, value.z, value.w);
+			data += sizeof(float) * 4;
+			break;
+		}
+		case UniformType::Mat4:
+		{
+			glm::mat4 matrix;
+			memcpy(&matrix[0][0], data, sizeof(float) * 16);
+			command.shader->SetUniformMat4f(header.location, matrix);
+			data += sizeof(float) * 16;
+			break;
+		}
+		}
+	}
+}
+
+RenderQueue::RenderQueue()
+	: m_OutsideThread(std::thread::id())
+{
+	MEMORY_TAG(Rendering);
+	int buffers = JobSystem::Get().GetThreadCount() + 1;
+	for (int i = 0; i < buffers; i++)
+	{
+		m_Buffers.push_back(std::make_unique<RenderCommandBuffer>());
+	}
+}
+
+RenderCommandBuffer& RenderQueue::GetBuffer()
+{
+	int index = JobSystem::GetThreadIndex();
+	if (index >= 0 && index < (int)m_Buffers.size() - 1)
+		return *m_Buffers[index];
+
+	//On failure owner is loaded with the thread that got there first
+	std::thread::id thread = std::this_thread::get_id(), owner;
+	m_OutsideThread.compare_exchange_strong(owner, thread);
+	ASSERT(owner == std::thread::id() || owner == thread);
+	return *m_Buffers.back();
+}
+
+void RenderQueue::Submit(const Renderer& renderer)
+{
+	FrameVector<SortEntry> entries;
+	{
+		PROFILE_SCOPE("RenderQueue::Sort");
+		entries.reserve(GetCommandCount());
+		for (uint32_t buffer = 0; buffer < (uint32_t)m_Buffers.size(); buffer++)
+		{
+			const std::vector<RenderCommand>& commands = m_Buffers[buffer]->GetCommands();
+			for (uint32_t command = 0; command < (uint32_t)commands.size(); command++)
+			{
+				entries.push_back({ commands[command].sortKey, buffer, command });
+			}
+		}
+
+		//Ties fall back to the buffer and recording order, which keeps
+		//draws with equal keys from swapping places between frames
+		std::sort(entries.begin(), entries.end(), [](const SortEntry& a, const SortEntry& b) {
+			if (a.key != b.key)
+				return a.key < b.key;
+			if (a.buffer != b.buffer)
+				return a.buffer < b.buffer;
+			return a.command < b.command;
+		});
+	}
+
+	PROFILE_SCOPE("RenderQueue::Replay");
+	const Shader* shader = nullptr;
+	const Texture* texture = nullptr;
+	const VertexArray* vertexArray = nullptr;
+	const IndexBuffer* indexBuffer = nullptr;
+	for (const SortEntry& entry : entries)
+	{
+		const RenderCommandBuffer& buffer = *m_Buffers[entry.buffer];
+		const RenderCommand& command = buffer.GetCommands()[entry.command];
+
+		if (command.shader != shader)
+		{
+			command.shader->Bind();
+			shader = command.shader;
+		}
+		if (command.texture && command.texture != texture)
+		{
+			command.texture->Bind();
+			texture = command.texture;
+		}
+		//The element buffer binding is part of the vertex array's state
+		if (command.vertexArray != vertexArray)
+		{
+			command.vertexArray->Bind();
+			vertexArray = command.vertexArray;
+			indexBuffer = nullptr;
+		}
+		if (command.indexBuffer != indexBuffer)
+		{
+			command.indexBuffer->Bind();
+			indexBuffer = command.indexBuffer;
+		}
+
+		buffer.ApplyUniforms(command);
+		renderer.DrawElements(*command.indexBuffer);
+	}
+
+	for (std::unique_ptr<RenderCommandBuffer>& buffer : m_Buffers)
+	{
+		buffer->Reset();
+	}
+	m_OutsideThread = std::thread::id();
+}
+
+size_t RenderQueue::GetCommandCount() const
+{
+	size_t count = 0;
+	for (const std::unique_ptr<RenderCommandBuffer>& buffer : m_Buffers)
+	{
+		count += buffer->GetCommands().size();
+	}
+	return count;
+}
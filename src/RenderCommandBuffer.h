@@ -0,0 +1,104 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+class Renderer;
+class Shader;
+class Texture;
+class VertexArray;
+class IndexBuffer;
+
+//A recorded draw. The resources must outlive the frame, and the uniforms
+//are packed into the recording buffer's byte array rather than the command
+//so commands stay a fixed size and cheap to sort
+struct RenderCommand {
+	uint64_t sortKey;
+	const VertexArray* vertexArray;
+	const IndexBuffer* indexBuffer;
+	Shader* shader;
+	const Texture* texture;
+	uint32_t uniformOffset;
+	uint32_t uniformCount;
+
+	//Layer first, then the program and texture so draws that share them
+	//end up next to each other, then depth in [0, 1] within those
+	static inline uint64_t MakeSortKey(unsigned int layer, unsigned int shader, unsigned int texture, float depth)
+	{
+		uint64_t quantized = (uint64_t)(glm::clamp(depth, 0.0f, 1.0f) * 0xFFFFFF);
+		return ((uint64_t)(layer & 0xFF) << 56) | ((uint64_t)(shader & 0xFFFF) << 40) | ((uint64_t)(texture & 0xFFFF) << 24) | quantized;
+	}
+};
+
+//Draws recorded by one thread. Recording makes no GL calls, so any thread
+//can fill a buffer as long as no other thread uses the same one, and uniform
+//locations have to be looked up beforehand on the thread with the context
+class RenderCommandBuffer
+{
+public:
+	enum class UniformType : uint32_t {
+		Int, Float, Vec4, Mat4
+	};
+
+private:
+	struct UniformHeader {
+		int location;
+		UniformType type;
+	};
+
+	std::vector<RenderCommand> m_Commands;
+	std::vector<unsigned char> m_Uniforms;
+
+public:
+	//Keeps the capacity so steady frames record without allocating
+	void Reset();
+
+	//Starts a command, uniforms set after it belong to it
+	void Draw(uint64_t sortKey, const VertexArray& va, const IndexBuffer& ib, Shader& shader, const Texture* texture = nullptr);
+
+	void SetUniform1i(int location, int value);
+	void SetUniform1f(int location, float value);
+	void SetUniform4f(int location, const glm::vec4& value);
+	void SetUniformMat4f(int location, const glm::mat4& matrix);
+
+	//Uploads a command's uniforms to its shader, which must be bound
+	void ApplyUniforms(const RenderCommand& command) const;
+
+	inline const std::vector<RenderCommand>& GetCommands() const { return m_Commands; }
+
+private:
+	void PushUniform(int location, UniformType type, const void* data, size_t size);
+};
+
+//One command buffer per job system thread, plus one for a single thread outside
+//it, such as the update thread. Only one outside thread may record between two
+//submits, a second one asserts in GetBuffer. Submit merges them, sorts by key and replays on the thread with the GL
+//context, skipping binds of whatever is already bound, then resets them.
+//The buffers keep their capacity and the sort runs in the frame arena, so
+//once they have grown to fit a scene recording doesn't allocate
+class RenderQueue
+{
+private:
+	struct SortEntry {
+		uint64_t key;
+		uint32_t buffer;
+		uint32_t command;
+	};
+
+	std::vector<std::unique_ptr<RenderCommandBuffer>> m_Buffers;
+	//The outside thread that has recorded since the last submit
+	std::atomic<std::thread::id> m_OutsideThread;
+
+public:
+	RenderQueue();
+
+	RenderCommandBuffer& GetBuffer();
+
+	void Submit(const Renderer& renderer);
+
+	size_t GetCommandCount() const;
+};
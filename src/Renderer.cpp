@@ -1,6 +1,9 @@
 #include "Renderer.h"
 #include <iostream>
 
+static RendererStats s_Stats;
+static RendererStats s_LastFrameStats;
+
 void GLClearError() {
     while (glGetError() != GL_NO_ERROR);
 }
@@ -13,6 +16,36 @@ bool GLLogCall(const char* function, const char* file, int line) {
     return true;
 }
 
+static void GLAPIENTRY GLDebugMessage(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* userParam)
+{
+    std::cout << "[OpenGL Debug] (" << id << "): " << message << std::endl;
+
+    //In synchronous mode this breaks inside the offending call
+    if (type == GL_DEBUG_TYPE_ERROR)
+    {
+        ASSERT(false);
+    }
+}
+
+bool EnableGLDebugOutput(bool synchronous)
+{
+    if (!GLEW_KHR_debug && !GLEW_VERSION_4_3)
+    {
+        std::cout << "Warning: KHR_debug isn't supported, GL errors won't be reported" << std::endl;
+        return false;
+    }
+
+    glEnable(GL_DEBUG_OUTPUT);
+    if (synchronous)
+        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    else
+        glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+
+    glDebugMessageCallback(GLDebugMessage, nullptr);
+    glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
+    return true;
+}
+
 void Renderer::Clear() const
 {
     GLCall(glClear(GL_COLOR_BUFFER_BIT));
@@ -22,5 +55,52 @@ void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, Shader& shader
     shader.Bind();
     va.Bind();
     ib.Bind();
-    GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), GL_UNSIGNED_INT, nullptr));
-}
\ No newline at end of file
+    DrawElements(ib);
+}
+
+void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, unsigned int count, Shader& shader) const {
+    shader.Bind();
+    va.Bind();
+    ib.Bind();
+    DrawElements(ib, count);
+}
+
+void Renderer::DrawElements(const IndexBuffer& ib) const
+{
+    DrawElements(ib, ib.GetCount());
+}
+
+void Renderer::DrawElements(const IndexBuffer& ib, unsigned int count) const
+{
+    GLCall(glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, nullptr));
+
+    s_Stats.DrawCalls++;
+    s_Stats.Triangles += count / 3;
+}
+
+RendererStats& Renderer::GetStats()
+{
+    return s_Stats;
+}
+
+const RendererStats& Renderer::GetLastFrameStats()
+{
+    return s_LastFrameStats;
+}
+
+void Renderer::EndFrame()
+{
+    s_LastFrameStats = s_Stats;
+    s_Stats = RendererStats();
+}
+
+void RendererStats::WriteJSON(std::ostream& stream) const
+{
+    stream << "{\"drawCalls\":" << DrawCalls
+        << ",\"triangles\":" << Triangles
+        << ",\"shaderBinds\":" << ShaderBinds
+        << ",\"textureBinds\":" << TextureBinds
+        << ",\"vertexArrayBinds\":" << VertexArrayBinds
+        << ",\"uniformUploads\":" << UniformUploads
+        << ",\"bytesUploaded\":" << BytesUploaded << "}";
+}
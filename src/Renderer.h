@@ -1,21 +1,81 @@
 #pragma once
 
 #include <GL/glew.h>
+#include <cstddef>
+#include <iosfwd>
 #include "Shader.h"
 #include "VertexArray.h"
 #include "IndexBuffer.h"
 
-#define ASSERT(x) if (!(x)) __debugbreak();
+#ifdef _MSC_VER
+#define DEBUG_BREAK() __debugbreak()
+#else
+#include <csignal>
+#define DEBUG_BREAK() raise(SIGTRAP)
+#endif
+
+//How GL errors are reported, chosen at compile time:
+//  GL_ERROR_CHECKS         polls glGetError around every GLCall, which makes the
+//                          driver synchronize, on by default in debug builds
+//  GL_DEBUG_CALLBACK       KHR_debug callback, synchronous so a break lands in the failing call
+//  GL_DEBUG_CALLBACK_ASYNC KHR_debug callback, asynchronous and close to free
+//Release builds compile all of it out unless one of them is defined
+#if defined(_DEBUG) && !defined(GL_DEBUG_CALLBACK) && !defined(GL_DEBUG_CALLBACK_ASYNC) && !defined(GL_ERROR_CHECKS)
+#define GL_ERROR_CHECKS
+#endif
+
+#ifdef _DEBUG
+#define ASSERT(x) if (!(x)) DEBUG_BREAK();
+#else
+#define ASSERT(x)
+#endif
+
+//Errors are logged whenever the checks are compiled in, only debug builds break on them
+#ifdef _DEBUG
+#define GL_ERROR_BREAK() DEBUG_BREAK()
+#else
+#define GL_ERROR_BREAK() ((void)0)
+#endif
+
+#ifdef GL_ERROR_CHECKS
 #define GLCall(x) GLClearError();\
     x;\
-    ASSERT(GLLogCall(#x, __FILE__, __LINE__))
+    if (!GLLogCall(#x, __FILE__, __LINE__)) GL_ERROR_BREAK();
+#else
+#define GLCall(x) x;
+#endif
 
 
 void GLClearError();
 bool GLLogCall(const char* function, const char* file, int line);
+//Registers the KHR_debug message callback, returns false if unsupported
+bool EnableGLDebugOutput(bool synchronous);
+
+//Work submitted to GL during a frame, counted at the wrapper classes
+struct RendererStats {
+    unsigned int DrawCalls = 0;
+    unsigned int Triangles = 0;
+    unsigned int ShaderBinds = 0;
+    unsigned int TextureBinds = 0;
+    unsigned int VertexArrayBinds = 0;
+    unsigned int UniformUploads = 0;
+    size_t BytesUploaded = 0;
+
+    void WriteJSON(std::ostream& stream) const;
+};
 
 class Renderer {
 public:
     void Clear() const;
     void Draw(const VertexArray& va, const IndexBuffer&, Shader& shader) const;
+    //Draws only the first count indices
+    void Draw(const VertexArray& va, const IndexBuffer& ib, unsigned int count, Shader& shader) const;
+    //Draws with whatever is bound, for callers that skip redundant binds themselves
+    void DrawElements(const IndexBuffer& ib) const;
+    void DrawElements(const IndexBuffer& ib, unsigned int count) const;
+
+    //Stats of the frame being recorded and of the last completed one
+    static RendererStats& GetStats();
+    static const RendererStats& GetLastFrameStats();
+    static void EndFrame();
 };
@@ -0,0 +1,125 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+//Refers to an object in a ResourcePool<T>. A slot's generation is bumped when
+//its object is destroyed, so a handle that outlived its object is detected
+//instead of silently referring to whatever reuses the slot. A default
+//constructed handle is null, generations start at 1
+template<typename T>
+struct Handle {
+	uint32_t Index = 0;
+	uint32_t Generation = 0;
+
+	inline bool IsNull() const { return Generation == 0; }
+	inline bool operator==(const Handle& other) const { return Index == other.Index && Generation == other.Generation; }
+	inline bool operator!=(const Handle& other) const { return !(*this == other); }
+};
+
+//Stores objects by value in one contiguous array and hands out generational
+//handles to them. Freed slots are reused, so creating and destroying objects
+//doesn't allocate once the pool has grown. Growing the pool moves the objects,
+//so pointers from Get are only valid until the next Create. Not thread safe
+template<typename T>
+class ResourcePool
+{
+private:
+	struct Slot {
+		std::optional<T> object;
+		uint32_t generation;
+	};
+
+	std::vector<Slot> m_Slots;
+	std::vector<uint32_t> m_FreeSlots;
+	size_t m_Count;
+
+public:
+	ResourcePool()
+		: m_Count(0)
+	{
+	}
+
+	template<typename... Args>
+	Handle<T> Create(Args&&... args)
+	{
+		uint32_t index;
+		if (!m_FreeSlots.empty())
+		{
+			index = m_FreeSlots.back();
+			m_FreeSlots.pop_back();
+		}
+		else
+		{
+			index = (uint32_t)m_Slots.size();
+			m_Slots.push_back({ std::nullopt, 1 });
+		}
+
+		Slot& slot = m_Slots[index];
+		slot.object.emplace(std::forward<Args>(args)...);
+		m_Count++;
+		return { index, slot.generation };
+	}
+
+	//Returns false if the handle is null or its object was already destroyed
+	bool Destroy(Handle<T> handle)
+	{
+		if (!IsValid(handle))
+			return false;
+
+		Slot& slot = m_Slots[handle.Index];
+		slot.object.reset();
+		//Skips 0 on wrap around so a null handle never becomes valid
+		if (++slot.generation == 0)
+			slot.generation = 1;
+		m_FreeSlots.push_back(handle.Index);
+		m_Count--;
+		return true;
+	}
+
+	//nullptr if the handle is null or stale
+	T* Get(Handle<T> handle)
+	{
+		return IsValid(handle) ? &*m_Slots[handle.Index].object : nullptr;
+	}
+
+	const T* Get(Handle<T> handle) const
+	{
+		return IsValid(handle) ? &*m_Slots[handle.Index].object : nullptr;
+	}
+
+	bool IsValid(Handle<T> handle) const
+	{
+		return handle.Index < m_Slots.size() && m_Slots[handle.Index].generation == handle.Generation
+			&& m_Slots[handle.Index].object.has_value();
+	}
+
+	void Reserve(size_t count)
+	{
+		m_Slots.reserve(count);
+	}
+
+	void Clear()
+	{
+		for (uint32_t i = 0; i < m_Slots.size(); i++)
+		{
+			if (m_Slots[i].object)
+				Destroy({ i, m_Slots[i].generation });
+		}
+	}
+
+	template<typename Function>
+	void ForEach(Function&& function)
+	{
+		for (uint32_t i = 0; i < m_Slots.size(); i++)
+		{
+			if (m_Slots[i].object)
+				function(Handle<T>{ i, m_Slots[i].generation }, *m_Slots[i].object);
+		}
+	}
+
+	inline size_t GetCount() const { return m_Count; }
+	inline size_t GetCapacity() const { return m_Slots.size(); }
+};
@@ -0,0 +1,55 @@
+#include "SIMD.h"
+
+#include <atomic>
+
+#if defined(SIMD_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static SIMDLevel DetectLevel()
+{
+#ifdef SIMD_X86
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 1);
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	bool avx = (info[2] & (1 << 28)) != 0;
+	//The OS also has to save the upper halves of the registers
+	bool supportsAVX = osxsave && avx && (_xgetbv(0) & 6) == 6;
+#else
+	bool supportsAVX = __builtin_cpu_supports("avx");
+#endif
+	return supportsAVX ? SIMDLevel::AVX : SIMDLevel::SSE;
+#else
+	return SIMDLevel::Scalar;
+#endif
+}
+
+static const SIMDLevel s_SupportedLevel = DetectLevel();
+static std::atomic<SIMDLevel> s_Level(s_SupportedLevel);
+
+SIMDLevel SIMD::GetSupportedLevel()
+{
+	return s_SupportedLevel;
+}
+
+SIMDLevel SIMD::GetLevel()
+{
+	return s_Level.load(std::memory_order_relaxed);
+}
+
+void SIMD::SetLevel(SIMDLevel level)
+{
+	s_Level.store(level > s_SupportedLevel ? s_SupportedLevel : level, std::memory_order_relaxed);
+}
+
+const char* SIMD::GetLevelName(SIMDLevel level)
+{
+	switch (level)
+	{
+	case SIMDLevel::Scalar: return "Scalar";
+	case SIMDLevel::SSE: return "SSE";
+	case SIMDLevel::AVX: return "AVX";
+	}
+	return "Unknown";
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+//x86 builds have SSE2 everywhere, AVX kernels are compiled alongside it
+//and only called once SIMD::GetLevel says the CPU supports them
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+//MSVC allows AVX intrinsics in any function
+#define SIMD_AVX_FUNCTION
+#else
+#define SIMD_AVX_FUNCTION __attribute__((target("avx")))
+#endif
+#endif
+
+enum class SIMDLevel {
+	Scalar, SSE, AVX
+};
+
+//Which instruction set the SIMD kernels use, shared by all of them
+class SIMD
+{
+public:
+	//The best level this CPU supports, used unless SetLevel picks another
+	static SIMDLevel GetSupportedLevel();
+	static SIMDLevel GetLevel();
+	//Levels above the supported one are clamped to it
+	static void SetLevel(SIMDLevel level);
+	static const char* GetLevelName(SIMDLevel level);
+};
@@ -1,29 +1,84 @@
 #include "Shader.h"
 #include "GL/glew.h"
 
+#include <cstring>
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <sstream>
 
 #include "Renderer.h"
+#include "AssetArchive.h"
+#include "MemoryTracker.h"
+#include "GPUDeletionQueue.h"
 
 
+Shader::Shader()
+    : m_RendererID(0)
+{
+}
+
 Shader::Shader(const std::string& filepath)
 	: m_FilePath(filepath), m_RendererID(0)
 {
+    MEMORY_TAG(Shaders);
     ShaderProgramSource source = ParseShader(filepath);
     m_RendererID = CreateShader(source.VertexSource, source.FragmentSource);
 }
 
 Shader::~Shader()
 {
-    GLCall(glDeleteProgram(m_RendererID));
+    GPUDeletionQueue::Get().Release(GPUObjectType::Program, m_RendererID);
+}
+
+Shader::Shader(Shader&& other) noexcept
+    : m_FilePath(std::move(other.m_FilePath)), m_RendererID(other.m_RendererID),
+    m_UniformLocationCache(std::move(other.m_UniformLocationCache))
+{
+    other.m_RendererID = 0;
+    other.m_UniformLocationCache.clear();
+}
+
+Shader& Shader::operator=(Shader&& other) noexcept
+{
+    if (this != &other)
+    {
+        GPUDeletionQueue::Get().Release(GPUObjectType::Program, m_RendererID);
+
+        m_FilePath = std::move(other.m_FilePath);
+        m_RendererID = other.m_RendererID;
+        m_UniformLocationCache = std::move(other.m_UniformLocationCache);
+        other.m_RendererID = 0;
+        other.m_UniformLocationCache.clear();
+    }
+    return *this;
 }
 
 
 ShaderProgramSource Shader::ParseShader(const std::string& filePath) {
-    std::ifstream stream(filePath);
+    AssetData asset = AssetArchive::Get().Read(filePath);
+    if (!asset.IsValid())
+    {
+        std::cout << "Warning: shader '" << filePath << "' couldn't be loaded" << std::endl;
+        return {};
+    }
+
+    //Baked shaders have already been split and validated
+    const BakedShaderHeader* header = (const BakedShaderHeader*)asset.GetData();
+    if (asset.GetSize() >= sizeof(BakedShaderHeader) &&
+        memcmp(header->magic, BakedShaderHeader::Magic, sizeof(header->magic)) == 0 &&
+        header->version == BakedShaderHeader::Version &&
+        sizeof(BakedShaderHeader) + header->vertexSize + header->fragmentSize <= asset.GetSize())
+    {
+        const char* source = (const char*)(header + 1);
+        return { std::string(source, header->vertexSize), std::string(source + header->vertexSize, header->fragmentSize) };
+    }
+
+    return ParseShaderSource(std::string((const char*)asset.GetData(), asset.GetSize()));
+}
+
+ShaderProgramSource Shader::ParseShaderSource(const std::string& source) {
+    std::istringstream stream(source);
 
     enum class ShaderType {
         NONE = -1,
@@ -45,7 +100,7 @@ ShaderProgramSource Shader::ParseShader(const std::string& filePath) {
                 type = ShaderType::FRAGMENT;
             }
         }
-        else
+        else if (type != ShaderType::NONE)
         {
             ss[(int)type] << line << '\n';
         }
@@ -120,6 +175,7 @@ unsigned int Shader::CreateShader(const std::string& vertexShader, const std::st
 void Shader::Bind() const
 {
     GLCall(glUseProgram(m_RendererID));
+    Renderer::GetStats().ShaderBinds++;
 }
 
 void Shader::UnBind() const
@@ -129,25 +185,49 @@ void Shader::UnBind() const
 
 void Shader::SetUniform1i(const std::string& name, int value)
 {
-    GLCall(glUniform1i(GetUniformLocations(name), value));
+    SetUniform1i(GetUniformLocation(name), value);
 }
 
 void Shader::SetUniform1f(const std::string& name, float value)
 {
-    GLCall(glUniform1f(GetUniformLocations(name), value));
+    SetUniform1f(GetUniformLocation(name), value);
 }
 
 void Shader::SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3)
 {
-    GLCall(glUniform4f(GetUniformLocations(name), v0, v1, v2, v3));
+    SetUniform4f(GetUniformLocation(name), v0, v1, v2, v3);
 }
 
 void Shader::SetUniformMat4f(const std::string& name, const glm::mat4& matrix)
 {
-    GLCall(glUniformMatrix4fv(GetUniformLocations(name), 1, GL_FALSE, &matrix[0][0]));
+    SetUniformMat4f(GetUniformLocation(name), matrix);
+}
+
+void Shader::SetUniform1i(int location, int value)
+{
+    GLCall(glUniform1i(location, value));
+    Renderer::GetStats().UniformUploads++;
+}
+
+void Shader::SetUniform1f(int location, float value)
+{
+    GLCall(glUniform1f(location, value));
+    Renderer::GetStats().UniformUploads++;
+}
+
+void Shader::SetUniform4f(int location, float v0, float v1, float v2, float v3)
+{
+    GLCall(glUniform4f(location, v0, v1, v2, v3));
+    Renderer::GetStats().UniformUploads++;
 }
 
-int Shader::GetUniformLocations(const std::string& name) const
+void Shader::SetUniformMat4f(int location, const glm::mat4& matrix)
+{
+    GLCall(glUniformMatrix4fv(location, 1, GL_FALSE, &matrix[0][0]));
+    Renderer::GetStats().UniformUploads++;
+}
+
+int Shader::GetUniformLocation(const std::string& name) const
 {
     if (m_UniformLocationCache.find(name) != m_UniformLocationCache.end())
     {
@@ -164,3 +244,16 @@ int Shader::GetUniformLocations(const std::string& name) const
     m_UniformLocationCache[name] = location;
 	return location;
 }
+
+bool Shader::SetUniformBlockBinding(const std::string& name, unsigned int binding)
+{
+    GLCall(unsigned int index = glGetUniformBlockIndex(m_RendererID, name.c_str()));
+    if (index == GL_INVALID_INDEX)
+    {
+        std::cout << "Warning: uniform block '" << name << "' doesn't exist" << std::endl;
+        return false;
+    }
+
+    GLCall(glUniformBlockBinding(m_RendererID, index, binding));
+    return true;
+}
@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <string>
 #include <unordered_map>
 #include "glm/glm.hpp"
@@ -8,6 +9,18 @@ struct ShaderProgramSource {
 	std::string FragmentSource;
 };
 
+//Layout written by the asset baker: the header followed by the
+//preprocessed vertex and fragment sources, neither null terminated
+struct BakedShaderHeader {
+	char magic[4];
+	uint32_t version;
+	uint32_t vertexSize;
+	uint32_t fragmentSize;
+
+	static constexpr char Magic[4] = { 'L', 'G', 'S', 'H' };
+	static const uint32_t Version = 1;
+};
+
 class Shader
 {
 private:
@@ -16,9 +29,15 @@ private:
 	mutable std::unordered_map<std::string, int> m_UniformLocationCache;
 
 public:
+	Shader();
 	Shader(const std::string& filepath);
 	~Shader();
 
+	Shader(const Shader&) = delete;
+	Shader& operator=(const Shader&) = delete;
+	Shader(Shader&& other) noexcept;
+	Shader& operator=(Shader&& other) noexcept;
+
 	void Bind() const;
 	void UnBind() const;
 
@@ -27,9 +46,23 @@ public:
 	void SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3);
 	void SetUniformMat4f(const std::string& name, const glm::mat4& matrix);
 
+	//Locations looked up ahead of time, which is how recorded commands refer to uniforms
+	void SetUniform1i(int location, int value);
+	void SetUniform1f(int location, float value);
+	void SetUniform4f(int location, float v0, float v1, float v2, float v3);
+	void SetUniformMat4f(int location, const glm::mat4& matrix);
+
+	//Caches the lookup, so only call it from the thread with the GL context
+	int GetUniformLocation(const std::string& name) const;
+	//Points the named uniform block at a UniformBuffer binding point, returns false if it doesn't exist
+	bool SetUniformBlockBinding(const std::string& name, unsigned int binding);
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+
+	//Splits a .shader file into its stages at the #shader lines
+	static ShaderProgramSource ParseShaderSource(const std::string& source);
+	static unsigned int CompileShader(unsigned int type, const std::string& source);
+
 private:
 	ShaderProgramSource ParseShader(const std::string& filePath);
-	unsigned int CompileShader(unsigned int type, const std::string& source);
 	unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader);
-	int GetUniformLocations(const std::string& name) const;
 };
\ No newline at end of file
@@ -0,0 +1,143 @@
+#include "SpatialGrid.h"
+#include "Culling.h"
+
+#include <algorithm>
+#include <cmath>
+
+SpatialGrid::SpatialGrid(const glm::vec2& origin, const glm::vec2& size, float cellSize)
+	: m_Origin(origin), m_CellSize(cellSize), m_InverseCellSize(1.0f / cellSize),
+	m_CellsX(std::max(1, (int)std::ceil(size.x / cellSize))), m_CellsY(std::max(1, (int)std::ceil(size.y / cellSize))),
+	m_MaxHalfExtent(0.0f), m_Count(0)
+{
+	m_Cells.resize((size_t)m_CellsX * m_CellsY);
+}
+
+void SpatialGrid::Clear()
+{
+	for (std::vector<unsigned int>& cell : m_Cells)
+		cell.clear();
+	for (Entry& entry : m_Entries)
+		entry.cell = -1;
+	m_MaxHalfExtent = glm::vec2(0.0f);
+	m_Count = 0;
+}
+
+void SpatialGrid::Build(const BoundsArrays& bounds, size_t count)
+{
+	Clear();
+	for (size_t i = 0; i < count; i++)
+	{
+		Insert((unsigned int)i, glm::vec2(bounds.MinX[i], bounds.MinY[i]), glm::vec2(bounds.MaxX[i], bounds.MaxY[i]));
+	}
+}
+
+void SpatialGrid::Insert(unsigned int id, const glm::vec2& min, const glm::vec2& max)
+{
+	if (id >= m_Entries.size())
+		m_Entries.resize(id + 1, { glm::vec2(0.0f), glm::vec2(0.0f), -1, 0 });
+
+	if (m_Entries[id].cell >= 0)
+	{
+		Update(id, min, max);
+		return;
+	}
+
+	Entry& entry = m_Entries[id];
+	entry.min = min;
+	entry.max = max;
+	m_MaxHalfExtent = glm::max(m_MaxHalfExtent, (max - min) * 0.5f);
+	AddToCell(id, GetCell((min + max) * 0.5f));
+	m_Count++;
+}
+
+void SpatialGrid::Update(unsigned int id, const glm::vec2& min, const glm::vec2& max)
+{
+	if (!Contains(id))
+	{
+		Insert(id, min, max);
+		return;
+	}
+
+	Entry& entry = m_Entries[id];
+	entry.min = min;
+	entry.max = max;
+	m_MaxHalfExtent = glm::max(m_MaxHalfExtent, (max - min) * 0.5f);
+
+	int cell = GetCell((min + max) * 0.5f);
+	if (cell != entry.cell)
+	{
+		RemoveFromCell(id);
+		AddToCell(id, cell);
+	}
+}
+
+void SpatialGrid::Remove(unsigned int id)
+{
+	if (!Contains(id))
+		return;
+
+	RemoveFromCell(id);
+	m_Entries[id].cell = -1;
+	m_Count--;
+}
+
+bool SpatialGrid::Contains(unsigned int id) const
+{
+	return id < m_Entries.size() && m_Entries[id].cell >= 0;
+}
+
+void SpatialGrid::QueryRect(const glm::vec2& min, const glm::vec2& max, std::vector<unsigned int>& results) const
+{
+	//An object in a cell can reach out of it by up to its half extent
+	int cellMinX, cellMinY, cellMaxX, cellMaxY;
+	int first = GetCell(min - m_MaxHalfExtent), last = GetCell(max + m_MaxHalfExtent);
+	cellMinX = first % m_CellsX;
+	cellMinY = first / m_CellsX;
+	cellMaxX = last % m_CellsX;
+	cellMaxY = last / m_CellsX;
+
+	for (int y = cellMinY; y <= cellMaxY; y++)
+	{
+		for (int x = cellMinX; x <= cellMaxX; x++)
+		{
+			for (unsigned int id : m_Cells[(size_t)y * m_CellsX + x])
+			{
+				const Entry& entry = m_Entries[id];
+				if (entry.max.x >= min.x && entry.min.x <= max.x && entry.max.y >= min.y && entry.min.y <= max.y)
+					results.push_back(id);
+			}
+		}
+	}
+}
+
+void SpatialGrid::QueryPoint(const glm::vec2& point, std::vector<unsigned int>& results) const
+{
+	QueryRect(point, point, results);
+}
+
+int SpatialGrid::GetCell(const glm::vec2& point) const
+{
+	glm::vec2 cell = (point - m_Origin) * m_InverseCellSize;
+	int x = (int)std::min(std::max(cell.x, 0.0f), (float)(m_CellsX - 1));
+	int y = (int)std::min(std::max(cell.y, 0.0f), (float)(m_CellsY - 1));
+	return y * m_CellsX + x;
+}
+
+void SpatialGrid::AddToCell(unsigned int id, int cell)
+{
+	std::vector<unsigned int>& objects = m_Cells[cell];
+	m_Entries[id].cell = cell;
+	m_Entries[id].slot = (unsigned int)objects.size();
+	objects.push_back(id);
+}
+
+//Swaps the last object of the cell into the removed one's slot
+void SpatialGrid::RemoveFromCell(unsigned int id)
+{
+	Entry& entry = m_Entries[id];
+	std::vector<unsigned int>& objects = m_Cells[entry.cell];
+	unsigned int moved = objects.back();
+	objects[entry.slot] = moved;
+	m_Entries[moved].slot = entry.slot;
+	objects.pop_back();
+}
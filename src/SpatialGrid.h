@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+struct BoundsArrays;
+
+//A loose uniform grid over 2D boxes. Each object lives in the single cell that
+//holds its centre, and queries widen the cells they visit by the largest half
+//extent seen, so moving an object only touches the grid when its centre
+//crosses into another cell. Objects are identified by caller chosen ids which
+//index a flat array, so they should be dense and start at 0. Positions outside
+//the grid's area are kept in the edge cells, which stays correct but slow
+class SpatialGrid
+{
+private:
+	struct Entry {
+		glm::vec2 min, max;
+		int cell;
+		unsigned int slot;
+	};
+
+	glm::vec2 m_Origin;
+	float m_CellSize, m_InverseCellSize;
+	int m_CellsX, m_CellsY;
+	std::vector<std::vector<unsigned int>> m_Cells;
+	std::vector<Entry> m_Entries;
+	glm::vec2 m_MaxHalfExtent;
+	size_t m_Count;
+
+public:
+	SpatialGrid(const glm::vec2& origin, const glm::vec2& size, float cellSize);
+
+	//Empties every cell but keeps their memory, so building again doesn't allocate
+	void Clear();
+	//Clears, then inserts boxes [0, count) with their index as the id
+	void Build(const BoundsArrays& bounds, size_t count);
+
+	void Insert(unsigned int id, const glm::vec2& min, const glm::vec2& max);
+	void Update(unsigned int id, const glm::vec2& min, const glm::vec2& max);
+	void Remove(unsigned int id);
+	bool Contains(unsigned int id) const;
+
+	//Appends the ids of the objects whose boxes overlap the rectangle or contain the point, in no particular order
+	void QueryRect(const glm::vec2& min, const glm::vec2& max, std::vector<unsigned int>& results) const;
+	void QueryPoint(const glm::vec2& point, std::vector<unsigned int>& results) const;
+
+	inline size_t GetCount() const { return m_Count; }
+	inline int GetCellCount() const { return m_CellsX * m_CellsY; }
+	inline float GetCellSize() const { return m_CellSize; }
+
+private:
+	int GetCell(const glm::vec2& point) const;
+	void AddToCell(unsigned int id, int cell);
+	void RemoveFromCell(unsigned int id);
+};
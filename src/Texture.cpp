@@ -1,37 +1,381 @@
 #include "Texture.h"
-#include "stb_image/stb_image.h"
+#include "TextureManager.h"
+#include "AssetArchive.h"
+#include "ImageDecoder.h"
+#include "MemoryTracker.h"
+#include "GPUMemory.h"
+#include "GPUDeletionQueue.h"
 
-Texture::Texture(const std::string& path)
-	: m_RendererID(0), m_FilePath(path), m_LocalBuffer(nullptr), m_Width(0), m_Height(0), m_BPP(0)
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+static GLenum GetInternalFormat(int channels)
+{
+	switch (channels)
+	{
+	case 1: return GL_R8;
+	case 2: return GL_RG8;
+	case 3: return GL_RGB8;
+	}
+	return GL_RGBA8;
+}
+
+static GLenum GetFormat(int channels)
+{
+	switch (channels)
+	{
+	case 1: return GL_RED;
+	case 2: return GL_RG;
+	case 3: return GL_RGB;
+	}
+	return GL_RGBA;
+}
+
+Texture::Texture()
+	: m_RendererID(0), m_Options(), m_Decoder(nullptr), m_LocalBuffer(nullptr), m_Width(0), m_Height(0), m_BPP(0),
+	m_Channels(4), m_InternalFormat(GL_RGBA8), m_Baked(false), m_MipLevels(1), m_MipBias(0)
+{
+}
+
+Texture::Texture(const std::string& path, const TextureLoadOptions& options)
+	: m_RendererID(0), m_FilePath(path), m_Options(options), m_Decoder(nullptr), m_LocalBuffer(nullptr), m_Width(0), m_Height(0), m_BPP(0),
+	m_Channels(4), m_InternalFormat(GL_RGBA8), m_Baked(false), m_MipLevels(1), m_MipBias(0)
+{
+	Load();
+	UpdateGPUMemory();
+	TextureManager::Get().Register(this);
+}
+
+Texture::~Texture()
+{
+	Release();
+}
+
+Texture::Texture(Texture&& other) noexcept
+{
+	MoveFrom(other);
+}
+
+Texture& Texture::operator=(Texture&& other) noexcept
 {
-	stbi_set_flip_vertically_on_load(1);
-	m_LocalBuffer = stbi_load(path.c_str(), &m_Width, &m_Height, &m_BPP, 4);
+	if (this != &other)
+	{
+		Release();
+		MoveFrom(other);
+	}
+	return *this;
+}
 
+void Texture::Release()
+{
+	TextureManager::Get().Unregister(this);
+	GPUMemory::Get().Untrack(this);
+	GPUDeletionQueue::Get().Release(GPUObjectType::Texture, m_RendererID);
+
+	if (m_LocalBuffer) {
+		m_Decoder->Free(m_LocalBuffer);
+	}
+	m_RendererID = 0;
+	m_LocalBuffer = nullptr;
+}
+
+void Texture::MoveFrom(Texture& other)
+{
+	m_RendererID = other.m_RendererID;
+	m_FilePath = std::move(other.m_FilePath);
+	m_Options = other.m_Options;
+	m_Decoder = other.m_Decoder;
+	m_LocalBuffer = other.m_LocalBuffer;
+	m_Width = other.m_Width;
+	m_Height = other.m_Height;
+	m_BPP = other.m_BPP;
+	m_Channels = other.m_Channels;
+	m_InternalFormat = other.m_InternalFormat;
+	m_Baked = other.m_Baked;
+	m_MipLevels = other.m_MipLevels;
+	m_MipBias = other.m_MipBias;
+
+	other.m_RendererID = 0;
+	other.m_LocalBuffer = nullptr;
+	TextureManager::Get().Move(&other, this);
+	GPUMemory::Get().Move(&other, this);
+}
+
+void Texture::Load()
+{
+	MEMORY_TAG(Textures);
+
+	//Any levels that were dropped under memory pressure before an
+	//eviction are dropped again once the texture has been reloaded
+	int bias = m_MipBias;
+	m_MipBias = 0;
+
+	//Decoding with the native channel count skips stb_image's second
+	//buffer for the RGBA conversion, and a kept local copy means a
+	//texture restored after eviction doesn't need to be decoded again
+	if (!m_LocalBuffer) {
+		//Decoding straight from the archive or a mapped file avoids stdio's
+		//buffered reads and the copies into the decoder's own read buffer
+		AssetData file = AssetArchive::Get().Read(m_FilePath);
+		if (LoadBaked(file, bias))
+			return;
+
+		m_Decoder = &ImageDecoder::Get();
+		if (file.IsValid())
+			m_LocalBuffer = m_Decoder->Decode(file.GetData(), file.GetSize(), m_Width, m_Height, m_BPP, m_Options.NativeChannels ? 0 : 4);
+
+		if (!m_LocalBuffer)
+			std::cout << "Warning: texture '" << m_FilePath << "' couldn't be loaded" << std::endl;
+	}
+	m_Channels = (m_Options.NativeChannels && m_LocalBuffer) ? m_BPP : 4;
+	m_InternalFormat = GetInternalFormat(m_Channels);
+
+	m_MipLevels = 1;
+	while ((m_Width >> m_MipLevels) > 0 || (m_Height >> m_MipLevels) > 0)
+		m_MipLevels++;
+
+	CreateTexture(m_MipLevels);
+
+	if (m_Options.UsePixelBuffer && m_LocalBuffer)
+	{
+		size_t size = GetLevelSize(0);
+		unsigned int pixelBuffer;
+		GLCall(glGenBuffers(1, &pixelBuffer));
+		GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer));
+		GLCall(glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW));
+		GLCall(void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+		memcpy(mapped, m_LocalBuffer, size);
+		GLCall(glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
+
+		//The decoded pixels now live in driver memory so the CPU side
+		//can be released before the upload has even been scheduled
+		if (!m_Options.KeepLocalCopy) {
+			m_Decoder->Free(m_LocalBuffer);
+			m_LocalBuffer = nullptr;
+		}
+
+		UploadLevel(0, nullptr);
+		GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+		GPUDeletionQueue::Get().Release(GPUObjectType::Buffer, pixelBuffer);
+	}
+	else
+	{
+		UploadLevel(0, m_LocalBuffer);
+	}
+
+	GLCall(glGenerateMipmap(GL_TEXTURE_2D));
+	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+
+	if (m_LocalBuffer && !m_Options.KeepLocalCopy) {
+		m_Decoder->Free(m_LocalBuffer);
+		m_LocalBuffer = nullptr;
+	}
+
+	while (m_MipBias < bias && DropMipLevel());
+}
+
+bool Texture::LoadBaked(const AssetData& file, int bias)
+{
+	//Baked textures are already flipped, mipmapped and possibly compressed
+	//so every level is uploaded exactly as it is stored
+	const BakedTextureHeader* header = (const BakedTextureHeader*)file.GetData();
+	if (!file.IsValid() || file.GetSize() < sizeof(BakedTextureHeader) ||
+		memcmp(header->magic, BakedTextureHeader::Magic, sizeof(header->magic)) != 0 || header->version != BakedTextureHeader::Version)
+		return false;
+
+	const uint32_t* levelSizes = (const uint32_t*)(header + 1);
+	size_t size = sizeof(BakedTextureHeader) + header->levels * sizeof(uint32_t);
+	for (uint32_t level = 0; level < header->levels && size <= file.GetSize(); level++)
+		size += levelSizes[level];
+
+	if (header->levels == 0 || size > file.GetSize())
+	{
+		std::cout << "Warning: baked texture '" << m_FilePath << "' is truncated" << std::endl;
+		return false;
+	}
+
+	m_Baked = true;
+	m_Width = header->width;
+	m_Height = header->height;
+	m_BPP = header->channels;
+	m_Channels = header->channels;
+	m_InternalFormat = header->internalFormat;
+	m_MipLevels = header->levels;
+	m_MipBias = std::min(bias, m_MipLevels - 1);
+
+	const unsigned char* data = (const unsigned char*)(levelSizes + m_MipLevels);
+
+	CreateTexture(m_MipLevels - m_MipBias);
+	GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+	for (int level = 0; level < m_MipLevels; level++)
+	{
+		if (level >= m_MipBias)
+		{
+			int width = std::max(1, m_Width >> level);
+			int height = std::max(1, m_Height >> level);
+			if (header->format == 0) {
+				GLCall(glCompressedTexImage2D(GL_TEXTURE_2D, level - m_MipBias, m_InternalFormat, width, height, 0, levelSizes[level], data));
+			}
+			else {
+				GLCall(glTexImage2D(GL_TEXTURE_2D, level - m_MipBias, m_InternalFormat, width, height, 0, header->format, GL_UNSIGNED_BYTE, data));
+			}
+			Renderer::GetStats().BytesUploaded += levelSizes[level];
+		}
+		data += levelSizes[level];
+	}
+	GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+
+	return true;
+}
+
+void Texture::CreateTexture(int levels)
+{
 	GLCall(glGenTextures(1, &m_RendererID));
 	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
 
-	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR));
 	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
 	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
 	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1));
 
-	GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_LocalBuffer));
-	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+	//Grayscale images are sampled as gray rather than red
+	if (m_Channels == 1) {
+		GLint swizzle[] = { GL_RED, GL_RED, GL_RED, GL_ONE };
+		GLCall(glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle));
+	}
+	else if (m_Channels == 2) {
+		GLint swizzle[] = { GL_RED, GL_RED, GL_RED, GL_GREEN };
+		GLCall(glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle));
+	}
+}
 
-	if (m_LocalBuffer) {
-		stbi_image_free(m_LocalBuffer);
+void Texture::UploadLevel(int level, const unsigned char* pixels)
+{
+	int width = std::max(1, m_Width >> (m_MipBias + level));
+	int height = std::max(1, m_Height >> (m_MipBias + level));
+
+	//Rows of R8, RG8 and RGB8 images aren't necessarily 4 byte aligned
+	GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+	GLCall(glTexImage2D(GL_TEXTURE_2D, level, m_InternalFormat, width, height, 0, GetFormat(m_Channels), GL_UNSIGNED_BYTE, pixels));
+	GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+	Renderer::GetStats().BytesUploaded += GetLevelSize(m_MipBias + level);
+}
+
+size_t Texture::GetLevelSize(int level) const
+{
+	size_t width = std::max(1, m_Width >> level);
+	size_t height = std::max(1, m_Height >> level);
+
+	switch (m_InternalFormat)
+	{
+	case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+		return ((width + 3) / 4) * ((height + 3) / 4) * 8;
+	case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+	case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+		return ((width + 3) / 4) * ((height + 3) / 4) * 16;
 	}
+	return width * height * m_Channels;
 }
 
-Texture::~Texture()
+size_t Texture::GetMemorySize() const
+{
+	if (!IsResident())
+		return 0;
+
+	size_t size = 0;
+	for (int level = m_MipBias; level < m_MipLevels; level++)
+		size += GetLevelSize(level);
+	return size;
+}
+
+const unsigned char* Texture::GetPixel(int x, int y) const
+{
+	if (!m_LocalBuffer || x < 0 || y < 0 || x >= m_Width || y >= m_Height)
+		return nullptr;
+
+	return m_LocalBuffer + ((size_t)y * m_Width + x) * m_Channels;
+}
+
+void Texture::Evict()
+{
+	if (!IsResident())
+		return;
+
+	GPUDeletionQueue::Get().Release(GPUObjectType::Texture, m_RendererID);
+	m_RendererID = 0;
+	UpdateGPUMemory();
+}
+
+void Texture::Restore()
 {
-	GLCall(glDeleteTextures(1, &m_RendererID));
+	if (IsResident())
+		return;
+
+	Load();
+	UpdateGPUMemory();
+}
+
+bool Texture::DropMipLevel()
+{
+	if (!IsResident() || m_MipLevels - m_MipBias <= 1)
+		return false;
+
+	//Baked levels can simply be uploaded again from the archive
+	if (m_Baked)
+	{
+		GPUDeletionQueue::Get().Release(GPUObjectType::Texture, m_RendererID);
+		m_RendererID = 0;
+		m_MipBias++;
+		Load();
+		UpdateGPUMemory();
+		return true;
+	}
+
+	//Reads back every level below the current base so the texture can be
+	//reallocated without its largest level, freeing roughly 3/4 of its memory
+	int levels = m_MipLevels - m_MipBias - 1;
+	std::vector<std::vector<unsigned char>> pixels(levels);
+
+	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	GLCall(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+	for (int i = 0; i < levels; i++)
+	{
+		pixels[i].resize(GetLevelSize(m_MipBias + 1 + i));
+		GLCall(glGetTexImage(GL_TEXTURE_2D, i + 1, GetFormat(m_Channels), GL_UNSIGNED_BYTE, pixels[i].data()));
+	}
+	GLCall(glPixelStorei(GL_PACK_ALIGNMENT, 4));
+	GPUDeletionQueue::Get().Release(GPUObjectType::Texture, m_RendererID);
+
+	m_MipBias++;
+
+	CreateTexture(levels);
+	for (int i = 0; i < levels; i++)
+		UploadLevel(i, pixels[i].data());
+	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+	UpdateGPUMemory();
+
+	return true;
+}
+
+//Evicted textures stay tracked at 0 bytes so they keep
+//their creation site for when they are restored
+void Texture::UpdateGPUMemory()
+{
+	GPUMemory::Get().Track(GPUMemoryCategory::Textures, this, m_RendererID, GetMemorySize(), m_FilePath);
 }
 
 void Texture::Bind(unsigned int slot) const
 {
+	TextureManager::Get().OnBind(this);
+
 	GLCall(glActiveTexture(GL_TEXTURE0 + slot));
 	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	Renderer::GetStats().TextureBinds++;
 }
 
 void Texture::UnBind()
@@ -1,20 +1,97 @@
 #pragma once
 #include "Renderer.h"
 
+#include <cstdint>
+
+class AssetData;
+class ImageDecoder;
+
+//Layout written by the asset baker: the header, one uint32_t byte size per
+//mip level, then the levels from largest to smallest, rows bottom first.
+//A format of 0 means the levels are in the compressed internalFormat
+struct BakedTextureHeader {
+	char magic[4];
+	uint32_t version;
+	uint32_t width;
+	uint32_t height;
+	uint32_t levels;
+	uint32_t channels;
+	uint32_t internalFormat;
+	uint32_t format;
+
+	static constexpr char Magic[4] = { 'L', 'G', 'T', 'X' };
+	static const uint32_t Version = 1;
+};
+
+struct TextureLoadOptions {
+	//Decodes into the image's own channel count (R8, RG8, RGB8)
+	//instead of expanding every image to RGBA8
+	bool NativeChannels = false;
+	//Keeps the decoded pixels on the CPU for GetPixel queries,
+	//baked textures are never decoded so they have no local copy
+	bool KeepLocalCopy = false;
+	//Streams the pixels to the driver through a pixel unpack buffer
+	bool UsePixelBuffer = false;
+};
+
 class Texture
 {
 private:
 	unsigned int m_RendererID;
 	std::string m_FilePath;
+	TextureLoadOptions m_Options;
+	ImageDecoder* m_Decoder;
 	unsigned char* m_LocalBuffer;
 	int m_Width, m_Height, m_BPP;
+	int m_Channels;
+	unsigned int m_InternalFormat;
+	bool m_Baked;
+	//Full mip chain length and how many of the largest
+	//levels have been dropped by the TextureManager
+	int m_MipLevels, m_MipBias;
 public:
-	Texture(const std::string& path);
+	//An empty texture that isn't registered with the TextureManager,
+	//for members that are moved into later
+	Texture();
+	Texture(const std::string& path, const TextureLoadOptions& options = TextureLoadOptions());
 	~Texture();
 
+	//Owns its GL name and local copy, so it can be moved but not copied.
+	//Moving hands the TextureManager and GPUMemory entries to the new object
+	Texture(const Texture&) = delete;
+	Texture& operator=(const Texture&) = delete;
+	Texture(Texture&& other) noexcept;
+	Texture& operator=(Texture&& other) noexcept;
+
 	void Bind(unsigned int slot = 0) const;
 	void UnBind();
 
+	//Residency controls used by the TextureManager
+	void Evict();
+	void Restore();
+	bool DropMipLevel();
+
+	size_t GetMemorySize() const;
+
+	//Returns the channels of a texel (origin bottom left) or
+	//nullptr if the texture was loaded without a local copy
+	const unsigned char* GetPixel(int x, int y) const;
+
+	inline bool IsResident() const { return m_RendererID != 0; }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
 	inline int GetWidth() const { return m_Width; }
 	inline int GetHeight() const { return m_Height; }
-};
\ No newline at end of file
+	inline int GetChannels() const { return m_Channels; }
+	inline int GetMipBias() const { return m_MipBias; }
+	inline const std::string& GetFilePath() const { return m_FilePath; }
+
+private:
+	void Release();
+	void MoveFrom(Texture& other);
+	void Load();
+	bool LoadBaked(const AssetData& file, int bias);
+	void CreateTexture(int levels);
+	void UploadLevel(int level, const unsigned char* pixels);
+	size_t GetLevelSize(int level) const;
+	void UpdateGPUMemory();
+};
@@ -0,0 +1,174 @@
+#include "TextureManager.h"
+#include "Texture.h"
+#include "MemoryTracker.h"
+
+#include <algorithm>
+#include <vector>
+
+TextureManager::TextureManager()
+	: m_Frame(0), m_Stats()
+{
+	m_Stats.BudgetBytes = 256 * 1024 * 1024;
+}
+
+TextureManager& TextureManager::Get()
+{
+	static TextureManager instance;
+	return instance;
+}
+
+void TextureManager::Register(Texture* texture)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	MEMORY_TAG(Textures);
+	m_Textures[texture] = { texture, m_Frame };
+	EnforceBudget();
+}
+
+void TextureManager::Unregister(const Texture* texture)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Textures.erase(texture);
+	UpdateStats();
+}
+
+void TextureManager::Move(const Texture* from, Texture* to)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	auto it = m_Textures.find(from);
+	if (it == m_Textures.end())
+		return;
+
+	Entry entry = it->second;
+	entry.texture = to;
+	m_Textures.erase(it);
+	m_Textures[to] = entry;
+}
+
+void TextureManager::OnBind(const Texture* texture)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	auto it = m_Textures.find(texture);
+	if (it == m_Textures.end())
+		return;
+
+	Entry& entry = it->second;
+	entry.lastBoundFrame = m_Frame;
+
+	if (!entry.texture->IsResident())
+	{
+		entry.texture->Restore();
+		m_Stats.Restores++;
+		EnforceBudget();
+	}
+}
+
+void TextureManager::NewFrame()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Frame++;
+	UpdateStats();
+}
+
+void TextureManager::SetBudget(size_t bytes)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Stats.BudgetBytes = bytes;
+	EnforceBudget();
+}
+
+size_t TextureManager::GetBudget() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_Stats.BudgetBytes;
+}
+
+TextureStats TextureManager::GetStats() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_Stats;
+}
+
+void TextureManager::EnforceBudget()
+{
+	UpdateStats();
+	if (m_Stats.ResidentBytes <= m_Stats.BudgetBytes)
+		return;
+
+	//Textures that haven't been bound this frame can be evicted outright,
+	//oldest first, and will be reloaded the next time they are bound
+	std::vector<Entry*> candidates;
+	for (auto& pair : m_Textures)
+	{
+		Entry& entry = pair.second;
+		if (entry.texture->IsResident() && entry.lastBoundFrame < m_Frame)
+			candidates.push_back(&entry);
+	}
+
+	std::sort(candidates.begin(), candidates.end(), [](const Entry* a, const Entry* b) {
+		return a->lastBoundFrame < b->lastBoundFrame;
+	});
+
+	for (Entry* entry : candidates)
+	{
+		if (m_Stats.ResidentBytes <= m_Stats.BudgetBytes)
+			break;
+
+		m_Stats.ResidentBytes -= entry->texture->GetMemorySize();
+		entry->texture->Evict();
+		m_Stats.Evictions++;
+	}
+
+	//Everything left is in use, so degrade quality instead by dropping the
+	//top mip level of whichever texture currently takes the most memory
+	std::vector<Texture*> resident;
+	for (auto& pair : m_Textures)
+	{
+		if (pair.second.texture->IsResident())
+			resident.push_back(pair.second.texture);
+	}
+
+	while (m_Stats.ResidentBytes > m_Stats.BudgetBytes)
+	{
+		std::sort(resident.begin(), resident.end(), [](const Texture* a, const Texture* b) {
+			return a->GetMemorySize() > b->GetMemorySize();
+		});
+
+		bool dropped = false;
+		for (Texture* texture : resident)
+		{
+			size_t size = texture->GetMemorySize();
+			if (texture->DropMipLevel())
+			{
+				m_Stats.ResidentBytes -= size - texture->GetMemorySize();
+				m_Stats.MipDrops++;
+				dropped = true;
+				break;
+			}
+		}
+
+		if (!dropped)
+			break;
+	}
+
+	UpdateStats();
+}
+
+void TextureManager::UpdateStats()
+{
+	m_Stats.TextureCount = (unsigned int)m_Textures.size();
+	m_Stats.ResidentCount = 0;
+	m_Stats.ResidentBytes = 0;
+
+	for (auto& pair : m_Textures)
+	{
+		const Texture* texture = pair.second.texture;
+		if (texture->IsResident())
+		{
+			m_Stats.ResidentCount++;
+			m_Stats.ResidentBytes += texture->GetMemorySize();
+		}
+	}
+
+	m_Stats.PeakResidentBytes = std::max(m_Stats.PeakResidentBytes, m_Stats.ResidentBytes);
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+
+class Texture;
+
+struct TextureStats {
+	size_t BudgetBytes;
+	size_t ResidentBytes;
+	size_t PeakResidentBytes;
+	unsigned int TextureCount;
+	unsigned int ResidentCount;
+	unsigned int Evictions;
+	unsigned int Restores;
+	unsigned int MipDrops;
+};
+
+//Tracks the GPU memory of every live Texture and keeps the total under a
+//budget by evicting the least recently bound textures and, if that is not
+//enough, dropping the largest mip levels of the textures still in use.
+//Locked so textures can be destroyed or moved on any thread, evicting and
+//restoring still happen on the thread with the GL context that binds them
+class TextureManager
+{
+private:
+	mutable std::mutex m_Mutex;
+	struct Entry {
+		Texture* texture;
+		unsigned long long lastBoundFrame;
+	};
+
+	std::unordered_map<const Texture*, Entry> m_Textures;
+	unsigned long long m_Frame;
+	TextureStats m_Stats;
+
+	TextureManager();
+public:
+	static TextureManager& Get();
+
+	void Register(Texture* texture);
+	void Unregister(const Texture* texture);
+	void Move(const Texture* from, Texture* to);
+	void OnBind(const Texture* texture);
+
+	void NewFrame();
+
+	void SetBudget(size_t bytes);
+	size_t GetBudget() const;
+	TextureStats GetStats() const;
+
+private:
+	//Called with the mutex held
+	void EnforceBudget();
+	void UpdateStats();
+};
@@ -0,0 +1,64 @@
+#include "UniformBuffer.h"
+
+#include "Renderer.h"
+#include "GPUMemory.h"
+#include "GPUDeletionQueue.h"
+
+UniformBuffer::UniformBuffer()
+	: m_RendererID(0), m_Size(0), m_Binding(0)
+{
+}
+
+UniformBuffer::UniformBuffer(unsigned int size, unsigned int binding)
+	: m_Size(size), m_Binding(binding)
+{
+	GLCall(glGenBuffers(1, &m_RendererID));
+	GLCall(glBindBuffer(GL_UNIFORM_BUFFER, m_RendererID));
+	GLCall(glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW));
+	GLCall(glBindBufferBase(GL_UNIFORM_BUFFER, binding, m_RendererID));
+	GPUMemory::Get().Track(GPUMemoryCategory::UniformBuffers, this, m_RendererID, size);
+}
+
+UniformBuffer::~UniformBuffer()
+{
+	GPUMemory::Get().Untrack(this);
+	GPUDeletionQueue::Get().Release(GPUObjectType::Buffer, m_RendererID);
+}
+
+UniformBuffer::UniformBuffer(UniformBuffer&& other) noexcept
+	: m_RendererID(other.m_RendererID), m_Size(other.m_Size), m_Binding(other.m_Binding)
+{
+	other.m_RendererID = 0;
+	other.m_Size = 0;
+	GPUMemory::Get().Move(&other, this);
+}
+
+UniformBuffer& UniformBuffer::operator=(UniformBuffer&& other) noexcept
+{
+	if (this != &other)
+	{
+		GPUMemory::Get().Untrack(this);
+		GPUDeletionQueue::Get().Release(GPUObjectType::Buffer, m_RendererID);
+
+		m_RendererID = other.m_RendererID;
+		m_Size = other.m_Size;
+		m_Binding = other.m_Binding;
+		other.m_RendererID = 0;
+		other.m_Size = 0;
+		GPUMemory::Get().Move(&other, this);
+	}
+	return *this;
+}
+
+void UniformBuffer::Bind() const
+{
+	GLCall(glBindBufferBase(GL_UNIFORM_BUFFER, m_Binding, m_RendererID));
+}
+
+void UniformBuffer::SetData(const void* data, unsigned int size, unsigned int offset)
+{
+	ASSERT(offset + size <= m_Size);
+	GLCall(glBindBuffer(GL_UNIFORM_BUFFER, m_RendererID));
+	GLCall(glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data));
+	Renderer::GetStats().BytesUploaded += size;
+}
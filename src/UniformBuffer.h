@@ -0,0 +1,28 @@
+#pragma once
+
+
+//A dynamic uniform buffer that stays attached to one binding point, which
+//shaders point their uniform blocks at with Shader::SetUniformBlockBinding
+class UniformBuffer
+{
+private:
+	unsigned int m_RendererID;
+	unsigned int m_Size;
+	unsigned int m_Binding;
+public:
+	UniformBuffer();
+	UniformBuffer(unsigned int size, unsigned int binding);
+	~UniformBuffer();
+
+	UniformBuffer(const UniformBuffer&) = delete;
+	UniformBuffer& operator=(const UniformBuffer&) = delete;
+	UniformBuffer(UniformBuffer&& other) noexcept;
+	UniformBuffer& operator=(UniformBuffer&& other) noexcept;
+
+	//Attaches the buffer to its binding point again, in case another buffer took it
+	void Bind() const;
+	void SetData(const void* data, unsigned int size, unsigned int offset = 0);
+
+	inline unsigned int GetSize() const { return m_Size; }
+	inline unsigned int GetBinding() const { return m_Binding; }
+};
@@ -1,6 +1,7 @@
 #include "VertexArray.h"
 #include "Renderer.h"
 #include "VertexBufferLayout.h"
+#include "GPUDeletionQueue.h"
 
 VertexArray::VertexArray()
 {
@@ -9,7 +10,24 @@ VertexArray::VertexArray()
 
 VertexArray::~VertexArray()
 {
-	GLCall(glDeleteVertexArrays(1, &m_RendererID));
+	GPUDeletionQueue::Get().Release(GPUObjectType::VertexArray, m_RendererID);
+}
+
+VertexArray::VertexArray(VertexArray&& other) noexcept
+	: m_RendererID(other.m_RendererID)
+{
+	other.m_RendererID = 0;
+}
+
+VertexArray& VertexArray::operator=(VertexArray&& other) noexcept
+{
+	if (this != &other)
+	{
+		GPUDeletionQueue::Get().Release(GPUObjectType::VertexArray, m_RendererID);
+		m_RendererID = other.m_RendererID;
+		other.m_RendererID = 0;
+	}
+	return *this;
 }
 
 void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout)
@@ -31,6 +49,7 @@ void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& la
 void VertexArray::Bind() const
 {
 	GLCall(glBindVertexArray(m_RendererID));
+	Renderer::GetStats().VertexArrayBinds++;
 }
 
 void VertexArray::UnBind() const
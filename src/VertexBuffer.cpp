@@ -1,17 +1,61 @@
 #include "VertexBuffer.h"
 
 #include "Renderer.h"
+#include "GPUMemory.h"
+#include "GPUDeletionQueue.h"
+
+VertexBuffer::VertexBuffer()
+    : m_RendererID(0), m_Size(0)
+{
+}
 
 VertexBuffer::VertexBuffer(const void* data, unsigned int size)
+    : m_Size(size)
 {
     GLCall(glGenBuffers(1, &m_RendererID));
     GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
     GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW));
+    Renderer::GetStats().BytesUploaded += size;
+    GPUMemory::Get().Track(GPUMemoryCategory::VertexBuffers, this, m_RendererID, size);
+}
+
+VertexBuffer::VertexBuffer(unsigned int size)
+    : m_Size(size)
+{
+    GLCall(glGenBuffers(1, &m_RendererID));
+    GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
+    GLCall(glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_DYNAMIC_DRAW));
+    GPUMemory::Get().Track(GPUMemoryCategory::VertexBuffers, this, m_RendererID, size);
 }
 
 VertexBuffer::~VertexBuffer()
 {
-    GLCall(glDeleteBuffers(1, &m_RendererID));
+    GPUMemory::Get().Untrack(this);
+    GPUDeletionQueue::Get().Release(GPUObjectType::Buffer, m_RendererID);
+}
+
+VertexBuffer::VertexBuffer(VertexBuffer&& other) noexcept
+    : m_RendererID(other.m_RendererID), m_Size(other.m_Size)
+{
+    other.m_RendererID = 0;
+    other.m_Size = 0;
+    GPUMemory::Get().Move(&other, this);
+}
+
+VertexBuffer& VertexBuffer::operator=(VertexBuffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        GPUMemory::Get().Untrack(this);
+        GPUDeletionQueue::Get().Release(GPUObjectType::Buffer, m_RendererID);
+
+        m_RendererID = other.m_RendererID;
+        m_Size = other.m_Size;
+        other.m_RendererID = 0;
+        other.m_Size = 0;
+        GPUMemory::Get().Move(&other, this);
+    }
+    return *this;
 }
 
 void VertexBuffer::Bind() const
@@ -23,3 +67,21 @@ void VertexBuffer::UnBind() const
 {
     GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
 }
+
+void VertexBuffer::SetData(const void* data, unsigned int size)
+{
+    GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
+    if (size > m_Size)
+    {
+        GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, GL_DYNAMIC_DRAW));
+        m_Size = size;
+        GPUMemory::Get().Track(GPUMemoryCategory::VertexBuffers, this, m_RendererID, size);
+    }
+    else
+    {
+        //Orphans the old storage so the upload doesn't wait for draws still reading it
+        GLCall(glBufferData(GL_ARRAY_BUFFER, m_Size, nullptr, GL_DYNAMIC_DRAW));
+        GLCall(glBufferSubData(GL_ARRAY_BUFFER, 0, size, data));
+    }
+    Renderer::GetStats().BytesUploaded += size;
+}
@@ -5,10 +5,24 @@ class VertexBuffer
 {
 private:
 	unsigned int m_RendererID;
+	unsigned int m_Size;
 public:
+	VertexBuffer();
 	VertexBuffer(const void* data, unsigned int size);
+	//A dynamic buffer of size bytes to be filled with SetData
+	VertexBuffer(unsigned int size);
 	~VertexBuffer();
 
+	VertexBuffer(const VertexBuffer&) = delete;
+	VertexBuffer& operator=(const VertexBuffer&) = delete;
+	VertexBuffer(VertexBuffer&& other) noexcept;
+	VertexBuffer& operator=(VertexBuffer&& other) noexcept;
+
 	void Bind() const;
 	void UnBind() const;
+
+	//Replaces the contents, growing the buffer if they don't fit
+	void SetData(const void* data, unsigned int size);
+
+	inline unsigned int GetSize() const { return m_Size; }
 };
\ No newline at end of file
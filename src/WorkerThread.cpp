@@ -0,0 +1,60 @@
+#include "WorkerThread.h"
+
+#include "Profiler.h"
+
+WorkerThread::WorkerThread(const std::string& name)
+	: m_Busy(false), m_Quit(false)
+{
+	m_Thread = std::thread(&WorkerThread::Run, this, name);
+}
+
+WorkerThread::~WorkerThread()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Quit = true;
+	}
+	m_TaskReady.notify_one();
+	m_Thread.join();
+}
+
+void WorkerThread::Kick(std::function<void()> task)
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_TaskDone.wait(lock, [this] { return !m_Busy; });
+	m_Task = std::move(task);
+	m_Busy = true;
+	lock.unlock();
+	m_TaskReady.notify_one();
+}
+
+void WorkerThread::Wait()
+{
+	PROFILE_SCOPE("WorkerThread::Wait");
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_TaskDone.wait(lock, [this] { return !m_Busy; });
+}
+
+void WorkerThread::Run(std::string name)
+{
+	Profiler::Get().SetThreadName(name);
+
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	while (true)
+	{
+		m_TaskReady.wait(lock, [this] { return m_Busy || m_Quit; });
+		if (m_Busy)
+		{
+			std::function<void()> task = std::move(m_Task);
+			lock.unlock();
+			task();
+			lock.lock();
+			m_Busy = false;
+			m_TaskDone.notify_all();
+		}
+		else if (m_Quit)
+		{
+			return;
+		}
+	}
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+//A thread that runs one task at a time, handed over with Kick and joined
+//with Wait. The main loop uses it to run a test's update for the next frame
+//while the current one is rendered on the thread that owns the GL context
+class WorkerThread
+{
+private:
+	std::thread m_Thread;
+	std::mutex m_Mutex;
+	std::condition_variable m_TaskReady, m_TaskDone;
+	std::function<void()> m_Task;
+	bool m_Busy, m_Quit;
+
+public:
+	WorkerThread(const std::string& name);
+	~WorkerThread();
+
+	WorkerThread(const WorkerThread&) = delete;
+	WorkerThread& operator=(const WorkerThread&) = delete;
+
+	//Waits for the previous task before starting the next
+	void Kick(std::function<void()> task);
+	void Wait();
+
+private:
+	void Run(std::string name);
+};
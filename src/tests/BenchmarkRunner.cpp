@@ -0,0 +1,226 @@
+#include "BenchmarkRunner.h"
+#include "Test.h"
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+#include "Renderer.h"
+#include "GPUProfiler.h"
+#include "TextureManager.h"
+#include "FrameClock.h"
+#include "WorkerThread.h"
+#include "JobSystem.h"
+#include "FrameArena.h"
+#include "MemoryTracker.h"
+#include "GPUMemory.h"
+#include "GPUDeletionQueue.h"
+
+namespace test {
+
+	static float Percentile(const std::vector<float>& sorted, float percentile)
+	{
+		size_t index = (size_t)(percentile * (sorted.size() - 1) + 0.5f);
+		return sorted[std::min(index, sorted.size() - 1)];
+	}
+
+	//Test names come from the menu and are written as they are,
+	//so only quotes and backslashes need escaping
+	static std::string EscapeJSON(const std::string& text)
+	{
+		std::string escaped;
+		for (char c : text)
+		{
+			if (c == '"' || c == '\\')
+				escaped += '\\';
+			escaped += c;
+		}
+		return escaped;
+	}
+
+	bool BenchmarkRunner::Run(GLFWwindow* window, const TestMenu& menu, const BenchmarkOptions& options)
+	{
+		std::unique_ptr<Test> test(menu.CreateTest(options.TestName));
+		if (!test)
+		{
+			std::cout << "Error: no test named \"" << options.TestName << "\", available tests are:" << std::endl;
+			for (const std::string& name : menu.GetTestNames())
+			{
+				std::cout << "    " << name << std::endl;
+			}
+			return false;
+		}
+
+		if (options.Frames <= 0)
+		{
+			std::cout << "Error: benchmark needs at least one frame" << std::endl;
+			return false;
+		}
+
+		Renderer renderer;
+		std::vector<float> frameTimes;
+		frameTimes.reserve(options.Frames);
+
+		//Stats are summed over the recorded frames and averaged on output
+		double drawCalls = 0, triangles = 0, shaderBinds = 0, textureBinds = 0;
+		double vertexArrayBinds = 0, uniformUploads = 0, bytesUploaded = 0;
+		double heapAllocations = 0;
+
+		FrameClock clock;
+		std::unique_ptr<WorkerThread> updateThread;
+		if (test->IsThreaded())
+		{
+			updateThread = std::make_unique<WorkerThread>("Update");
+		}
+
+		auto update = [&clock, &test]() {
+			while (clock.StepFixed())
+			{
+				test->OnFixedUpdate(clock.GetFixedTimestep());
+			}
+			test->OnUpdate(clock.GetDeltaTime());
+		};
+
+		std::cout << "Benchmarking " << options.TestName << " for " << options.Frames << " frames" << std::endl;
+
+		//The clock's first tick has no previous frame, so it runs one extra
+		//frame and times are taken at the start of the next one
+		for (int frame = 0; frame <= options.WarmupFrames + options.Frames && !glfwWindowShouldClose(window); frame++)
+		{
+			clock.Tick();
+			FrameArena::NewFrame();
+			MemoryTracker::NewFrame();
+			if (frame > options.WarmupFrames)
+			{
+				frameTimes.push_back(clock.GetRawDeltaTime() * 1000.0f);
+
+				const RendererStats& stats = Renderer::GetLastFrameStats();
+				drawCalls += stats.DrawCalls;
+				triangles += stats.Triangles;
+				shaderBinds += stats.ShaderBinds;
+				textureBinds += stats.TextureBinds;
+				vertexArrayBinds += stats.VertexArrayBinds;
+				uniformUploads += stats.UniformUploads;
+				bytesUploaded += stats.BytesUploaded;
+				heapAllocations += MemoryTracker::GetLastFrameAllocations();
+			}
+			if (frame == options.WarmupFrames + options.Frames)
+				break;
+
+			GPUProfiler::Get().BeginFrame();
+			TextureManager::Get().NewFrame();
+			JobSystem::Get().ProcessMainThreadJobs();
+
+			{
+				GPU_PROFILE_SCOPE("Clear");
+				renderer.Clear();
+			}
+
+			if (updateThread)
+			{
+				updateThread->Kick(update);
+				{
+					GPU_PROFILE_SCOPE("Test");
+					test->OnRender();
+				}
+				updateThread->Wait();
+				test->OnPublish();
+			}
+			else
+			{
+				update();
+				test->OnPublish();
+				GPU_PROFILE_SCOPE("Test");
+				test->OnRender();
+			}
+
+			GPUProfiler::Get().EndFrame();
+			GPUDeletionQueue::Get().EndFrame();
+			Renderer::EndFrame();
+
+			glfwSwapBuffers(window);
+			glfwPollEvents();
+		}
+
+		if (frameTimes.empty())
+		{
+			std::cout << "Error: window closed before any frames were recorded" << std::endl;
+			return false;
+		}
+
+		std::vector<float> sorted = frameTimes;
+		std::sort(sorted.begin(), sorted.end());
+
+		double total = 0.0;
+		for (float time : sorted)
+		{
+			total += time;
+		}
+		double frames = (double)sorted.size();
+		float average = (float)(total / frames);
+
+		std::ofstream stream(options.OutputPath);
+		if (!stream)
+		{
+			std::cout << "Error: could not write " << options.OutputPath << std::endl;
+			return false;
+		}
+
+		stream << "{\n";
+		stream << "  \"test\": \"" << EscapeJSON(options.TestName) << "\",\n";
+		stream << "  \"renderer\": \"" << EscapeJSON((const char*)glGetString(GL_RENDERER)) << "\",\n";
+		stream << "  \"version\": \"" << EscapeJSON((const char*)glGetString(GL_VERSION)) << "\",\n";
+		stream << "  \"threaded\": " << (updateThread ? "true" : "false") << ",\n";
+		stream << "  \"warmupFrames\": " << options.WarmupFrames << ",\n";
+		stream << "  \"frames\": " << sorted.size() << ",\n";
+		stream << "  \"frameTimeMs\": {\"min\":" << sorted.front()
+			<< ",\"avg\":" << average
+			<< ",\"p50\":" << Percentile(sorted, 0.50f)
+			<< ",\"p95\":" << Percentile(sorted, 0.95f)
+			<< ",\"p99\":" << Percentile(sorted, 0.99f)
+			<< ",\"max\":" << sorted.back() << "},\n";
+		stream << "  \"rendererStats\": {\"drawCalls\":" << drawCalls / frames
+			<< ",\"triangles\":" << triangles / frames
+			<< ",\"shaderBinds\":" << shaderBinds / frames
+			<< ",\"textureBinds\":" << textureBinds / frames
+			<< ",\"vertexArrayBinds\":" << vertexArrayBinds / frames
+			<< ",\"uniformUploads\":" << uniformUploads / frames
+			<< ",\"bytesUploaded\":" << bytesUploaded / frames << "},\n";
+		stream << "  \"heapAllocationsPerFrame\": " << heapAllocations / frames << ",\n";
+		stream << "  \"memory\": ";
+		MemoryTracker::WriteJSON(stream);
+		stream << ",\n";
+		stream << "  \"gpuMemory\": ";
+		GPUMemory::Get().WriteJSON(stream);
+		stream << ",\n";
+
+		stream << "  \"gpuTimings\": [";
+		std::vector<GPUTimingStats> gpuStats = GPUProfiler::Get().GetStats();
+		for (size_t i = 0; i < gpuStats.size(); i++)
+		{
+			const GPUTimingStats& stats = gpuStats[i];
+			stream << (i ? "," : "") << "\n    {\"name\":\"" << EscapeJSON(stats.Name)
+				<< "\",\"avgMs\":" << stats.AvgMs
+				<< ",\"minMs\":" << stats.MinMs
+				<< ",\"p99Ms\":" << stats.P99Ms
+				<< ",\"samples\":" << stats.Samples << "}";
+		}
+		stream << (gpuStats.empty() ? "],\n" : "\n  ],\n");
+
+		//Per frame times in order so regressions can be inspected over the run
+		stream << "  \"frameTimesMs\": [";
+		for (size_t i = 0; i < frameTimes.size(); i++)
+		{
+			stream << (i ? "," : "") << frameTimes[i];
+		}
+		stream << "]\n}" << std::endl;
+
+		std::cout << "Frame time avg " << average << " ms, p50 " << Percentile(sorted, 0.50f)
+			<< " ms, p99 " << Percentile(sorted, 0.99f) << " ms, written to " << options.OutputPath << std::endl;
+		return true;
+	}
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <string>
+
+struct GLFWwindow;
+
+namespace test {
+
+	class TestMenu;
+
+	struct BenchmarkOptions {
+		std::string TestName;
+		int Frames = 1000;
+		//Frames run before recording so shader compiles, first
+		//uploads and driver warm up don't land in the results
+		int WarmupFrames = 60;
+		std::string OutputPath = "benchmark.json";
+	};
+
+	//Runs a registered test without the menu or ImGui for a fixed number of
+	//frames and writes the frame time distribution and renderer stats as
+	//JSON. The window should be hidden with vsync off so frames aren't
+	//paced by the display
+	class BenchmarkRunner
+	{
+	public:
+		static bool Run(GLFWwindow* window, const TestMenu& menu, const BenchmarkOptions& options);
+	};
+}
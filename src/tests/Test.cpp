@@ -1,5 +1,6 @@
 #include "Test.h"
 #include "imgui/imgui.h"
+#include "GPUMemory.h"
 
 namespace test {
 	TestMenu::TestMenu(Test*& currentTestPointer)
@@ -12,8 +13,32 @@ namespace test {
 		for (auto& test : m_Tests)
 		{
 			if (ImGui::Button(test.first.c_str())) {
+				GPUMemorySite site(test.first.c_str());
 				m_CurrentTest = test.second();
 			}
 		}
 	}
+
+	Test* TestMenu::CreateTest(const std::string& name) const
+	{
+		for (auto& test : m_Tests)
+		{
+			if (test.first == name)
+			{
+				GPUMemorySite site(test.first.c_str());
+				return test.second();
+			}
+		}
+		return nullptr;
+	}
+
+	std::vector<std::string> TestMenu::GetTestNames() const
+	{
+		std::vector<std::string> names;
+		for (auto& test : m_Tests)
+		{
+			names.push_back(test.first);
+		}
+		return names;
+	}
 }
\ No newline at end of file
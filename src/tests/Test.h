@@ -12,10 +12,21 @@ namespace test {
 		Test() {}
 		virtual ~Test() {}
 
+		//Runs zero or more times per frame at a constant rate, before OnUpdate
+		virtual void OnFixedUpdate(float fixedDeltaTime) {}
 		virtual void OnUpdate(float deltaTime) {}
 		virtual void OnRender() {}
 		virtual void OnImGuiRender() {}
 
+		//Tests that return true have OnFixedUpdate and OnUpdate for the next
+		//frame run on a worker thread while OnRender submits the current one.
+		//They must not touch GL or anything OnRender reads, and instead copy
+		//what the frame needs into render state in OnPublish, which runs on
+		//the main thread once both have finished. OnImGuiRender runs after
+		//that, so it can still edit the simulation state directly
+		virtual bool IsThreaded() const { return false; }
+		virtual void OnPublish() {}
+
 	};
 
 	class TestMenu : public Test
@@ -32,6 +43,10 @@ namespace test {
 			m_Tests.push_back(std::make_pair(name, []() { return new T(); }));
 		}
 
+		//Creates a registered test by name, nullptr if there is none
+		Test* CreateTest(const std::string& name) const;
+		std::vector<std::string> GetTestNames() const;
+
 	private:
 		Test*& m_CurrentTest;
 		std::vector<std::pair<std::string, std::function<Test*()>>> m_Tests;
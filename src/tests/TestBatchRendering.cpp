@@ -1,8 +1,12 @@
 #include "TestBatchRendering.h"
 
+#include <chrono>
 #include <memory>
+#include <random>
 
 #include "Renderer.h"
+#include "MemoryTracker.h"
+#include "SIMD.h"
 #include "imgui/imgui.h"
 
 #include "glm/glm.hpp"
@@ -11,11 +15,17 @@
 
 namespace test {
 
+	static const int MaxSprites = 100000;
+
 	TestBatchRendering::TestBatchRendering()
-		: m_Translation(200, 200, 0),
-		m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f)),
-		m_View(glm::translate(glm::mat4(1.0f), glm::vec3(0, 0, 0)))
+		: m_Camera(0.0f, 960.0f, 0.0f, 540.0f),
+		m_Translation(200, 200, 0),
+		m_Velocity(120.0f, 90.0f, 0.0f), m_Animate(false), m_SpriteCount(0), m_WorldScale(1.0f), m_RenderTranslation(m_Translation),
+		m_RenderSpriteCount(0), m_RenderWorldScale(1.0f), m_RenderCullWithGrid(false), m_Cull(true), m_CullInParallel(true),
+		m_CullWithGrid(false), m_Grid(glm::vec2(0.0f), glm::vec2(960.0f, 540.0f) * 10.0f, 128.0f), m_GridWorldScale(1.0f), m_GridSpriteCount(-1), m_VisibleCount(0), m_CullMs(0.0f), m_Pretransform(true), m_SpriteMs(0.0f)
 	{
+		MEMORY_TAG(Meshes);
+
 		float positions[] = {
 			-50.0f, -50.0f, 0.0f, 0.0f,
 			 50.0f, -50.0f, 1.0f, 0.0f,
@@ -56,6 +66,52 @@ namespace test {
 
 		m_Texture = std::make_unique<Texture>("res/textures/destroyer.png");
 		m_Shader->SetUniform1i("u_Texture", 0);
+
+		m_BatchShader = Shader("res/shaders/batch.shader");
+		m_BatchShader.Bind();
+		m_BatchShader.SetUniform1i("u_Texture", 0);
+		m_BatchShader.SetUniformBlockBinding(CameraBuffer::BlockName, CameraBuffer::Binding);
+
+		float unitQuad[] = {
+			-0.5f, -0.5f, 0.0f, 0.0f,
+			 0.5f, -0.5f, 1.0f, 0.0f,
+			 0.5f,  0.5f, 1.0f, 1.0f,
+			-0.5f,  0.5f, 0.0f, 1.0f
+		};
+		m_UnitQuadBuffer = VertexBuffer(unitQuad, 4 * 4 * sizeof(float));
+		m_UnitQuadVAO.AddBuffer(m_UnitQuadBuffer, layout);
+		m_UnitQuadIndexBuffer = IndexBuffer(indicies, 6);
+
+		//Every sprite is two triangles over its own 4 vertices
+		std::vector<unsigned int> spriteIndices(MaxSprites * 6);
+		for (unsigned int i = 0; i < MaxSprites; i++)
+		{
+			unsigned int vertex = i * 4;
+			unsigned int* index = &spriteIndices[i * 6];
+			index[0] = vertex; index[1] = vertex + 1; index[2] = vertex + 2;
+			index[3] = vertex + 2; index[4] = vertex + 3; index[5] = vertex;
+		}
+		m_SpriteIndexBuffer = IndexBuffer(spriteIndices.data(), (unsigned int)spriteIndices.size());
+
+		//Vertices match QuadVertex, a position and a texture coordinate
+		m_SpriteBuffer = VertexBuffer(MaxSprites * 4 * sizeof(QuadVertex));
+		m_SpriteVAO.AddBuffer(m_SpriteBuffer, layout);
+		m_SpriteVertices.resize(MaxSprites * 4);
+
+		std::mt19937 random(1234);
+		std::uniform_real_distribution<float> x(0.0f, 960.0f), y(0.0f, 540.0f), angle(0.0f, 6.2831853f), spin(-3.0f, 3.0f), scale(8.0f, 32.0f);
+		m_Sprites.resize(MaxSprites);
+		for (Sprite& sprite : m_Sprites)
+		{
+			sprite.position = glm::vec3(x(random), y(random), 0.0f);
+			sprite.rotation = angle(random);
+			sprite.spin = spin(random);
+			sprite.scale = glm::vec2(scale(random), scale(random));
+		}
+		m_RenderSprites.Resize(MaxSprites);
+		m_RenderBounds.Resize(MaxSprites);
+		m_VisibleSprites.Resize(MaxSprites);
+		m_Visible.resize(MaxSprites);
 	}
 
 	TestBatchRendering::~TestBatchRendering()
@@ -65,6 +121,91 @@ namespace test {
 
 	void TestBatchRendering::OnUpdate(float deltaTime)
 	{
+		if (!m_Animate)
+			return;
+
+		for (int i = 0; i < m_SpriteCount; i++)
+		{
+			m_Sprites[i].rotation += m_Sprites[i].spin * deltaTime;
+		}
+
+		//Bounces the quads, which span -50 to 100 around the translation, off the edges
+		m_Translation += m_Velocity * deltaTime;
+		if ((m_Translation.x < 50.0f && m_Velocity.x < 0.0f) || (m_Translation.x > 860.0f && m_Velocity.x > 0.0f))
+			m_Velocity.x = -m_Velocity.x;
+		if ((m_Translation.y < 50.0f && m_Velocity.y < 0.0f) || (m_Translation.y > 440.0f && m_Velocity.y > 0.0f))
+			m_Velocity.y = -m_Velocity.y;
+	}
+
+	void TestBatchRendering::OnPublish()
+	{
+		m_RenderTranslation = m_Translation;
+
+		m_RenderSpriteCount = m_SpriteCount;
+		m_RenderWorldScale = m_WorldScale;
+		m_RenderCullWithGrid = m_CullWithGrid;
+		for (int i = 0; i < m_RenderSpriteCount; i++)
+		{
+			const Sprite& sprite = m_Sprites[i];
+			glm::vec3 position = sprite.position * m_RenderWorldScale;
+			m_RenderSprites.Set(i, position, sprite.rotation, sprite.scale);
+
+			//Half the diagonal covers the sprite at any rotation
+			float radius = 0.5f * glm::length(sprite.scale);
+			m_RenderBounds.Set(i, position - glm::vec3(radius, radius, 0.0f), position + glm::vec3(radius, radius, 0.0f));
+		}
+
+		//The grid is left alone while the other culling modes are used
+		//and rebuilt from scratch when culling with it is turned back on
+		if (!m_RenderCullWithGrid)
+		{
+			m_GridSpriteCount = -1;
+			return;
+		}
+
+		if (m_GridSpriteCount < 0)
+		{
+			m_Grid.Build(m_RenderBounds, m_RenderSpriteCount);
+		}
+		else
+		{
+			//Spinning doesn't change a sprite's bounds, so the grid only
+			//has to follow the world scale and the sprite count
+			bool moved = m_RenderWorldScale != m_GridWorldScale;
+			for (int i = 0; i < m_RenderSpriteCount; i++)
+			{
+				if (moved || i >= m_GridSpriteCount)
+					m_Grid.Update(i, glm::vec2(m_RenderBounds.MinX[i], m_RenderBounds.MinY[i]), glm::vec2(m_RenderBounds.MaxX[i], m_RenderBounds.MaxY[i]));
+			}
+			for (int i = m_RenderSpriteCount; i < m_GridSpriteCount; i++)
+				m_Grid.Remove(i);
+		}
+		m_GridWorldScale = m_RenderWorldScale;
+		m_GridSpriteCount = m_RenderSpriteCount;
+	}
+
+	void TestBatchRendering::DrawSpritesPretransformed(const Renderer& renderer, const TransformArrays& sprites, int count)
+	{
+		BatchTransform::ComputeQuads(sprites, 0, count, m_SpriteVertices.data());
+		m_SpriteBuffer.SetData(m_SpriteVertices.data(), count * 4 * sizeof(QuadVertex));
+
+		//The vertices are already in world space, so the camera block is all the shader needs
+		renderer.Draw(m_SpriteVAO, m_SpriteIndexBuffer, count * 6, m_BatchShader);
+	}
+
+	void TestBatchRendering::DrawSpritesPerDraw(const Renderer& renderer, const TransformArrays& sprites, int count)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(sprites.X[i], sprites.Y[i], 0.0f));
+			model = model * glm::mat4(glm::mat2(sprites.Cos[i], sprites.Sin[i], -sprites.Sin[i], sprites.Cos[i]));
+			model = glm::scale(model, glm::vec3(sprites.ScaleX[i], sprites.ScaleY[i], 1.0f));
+			glm::mat4 mvp = m_Camera.GetViewProjection() * model;
+			m_Shader->Bind();
+			m_Shader->SetUniformMat4f("u_MVP", mvp);
+
+			renderer.Draw(m_UnitQuadVAO, m_UnitQuadIndexBuffer, *m_Shader);
+		}
 	}
 
 	void TestBatchRendering::OnRender()
@@ -74,22 +215,76 @@ namespace test {
 
 		Renderer renderer;
 
+		m_CameraBuffer.Update(m_Camera);
 		m_Texture->Bind();
 
 		//What is entailed in a draw call
 		{
-			glm::mat4 model = glm::translate(glm::mat4(1.0f), m_Translation);
-			glm::mat4 mvp = m_Proj * m_View * model;
+			glm::mat4 model = glm::translate(glm::mat4(1.0f), m_RenderTranslation);
+			glm::mat4 mvp = m_Camera.GetViewProjection() * model;
 			m_Shader->Bind();
 			m_Shader->SetUniformMat4f("u_MVP", mvp);
 
 			renderer.Draw(*m_VAO, *m_IndexBuffer, *m_Shader);
 		}
+
+		auto start = std::chrono::high_resolution_clock::now();
+		const TransformArrays* sprites = &m_RenderSprites;
+		int count = m_RenderSpriteCount;
+		if (m_Cull && count > 0)
+		{
+			//The camera isn't rotated, so the visible rectangle is all of its frustum that matters
+			glm::vec2 min = m_Camera.GetMin(), max = m_Camera.GetMax();
+			size_t visible;
+			if (m_RenderCullWithGrid)
+			{
+				m_Visible.clear();
+				m_Grid.QueryRect(min, max, m_Visible);
+				visible = m_Visible.size();
+			}
+			else
+			{
+				m_Visible.resize(MaxSprites);
+				visible = m_CullInParallel
+					? Culling::CullRectParallel(m_RenderBounds, count, min, max, m_Visible.data())
+					: Culling::CullRect(m_RenderBounds, 0, count, min, max, m_Visible.data());
+			}
+			m_VisibleSprites.Gather(m_RenderSprites, m_Visible.data(), visible);
+
+			sprites = &m_VisibleSprites;
+			count = (int)visible;
+		}
+		m_VisibleCount = count;
+		m_CullMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+		if (count > 0)
+		{
+			if (m_Pretransform)
+				DrawSpritesPretransformed(renderer, *sprites, count);
+			else
+				DrawSpritesPerDraw(renderer, *sprites, count);
+		}
+		m_SpriteMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
 	}
 
 	void TestBatchRendering::OnImGuiRender()
 	{
 		ImGui::SliderFloat3("Translation: ", &m_Translation.x, 0.0f, 960.0f);
+		glm::vec3 cameraPosition = m_Camera.GetPosition();
+		if (ImGui::SliderFloat2("Camera", &cameraPosition.x, -480.0f, 960.0f * m_WorldScale))
+			m_Camera.SetPosition(cameraPosition);
+		ImGui::Checkbox("Animate", &m_Animate);
+		ImGui::SliderInt("Sprites", &m_SpriteCount, 0, MaxSprites);
+		ImGui::SliderFloat("World scale", &m_WorldScale, 1.0f, 10.0f);
+		ImGui::Checkbox("Cull", &m_Cull);
+		ImGui::SameLine();
+		ImGui::Checkbox("In parallel", &m_CullInParallel);
+		ImGui::SameLine();
+		ImGui::Checkbox("Spatial grid", &m_CullWithGrid);
+		ImGui::Text("%d of %d sprites visible, culling %.3f ms (%s)", m_VisibleCount, m_RenderSpriteCount, m_CullMs,
+			m_RenderCullWithGrid ? "grid" : SIMD::GetLevelName(SIMD::GetLevel()));
+		ImGui::Checkbox("Pretransform on the CPU", &m_Pretransform);
+		ImGui::Text("Sprites %.3f ms (%s)", m_SpriteMs, m_Pretransform ? "one draw, camera block" : "a draw and a uniform per sprite");
 		ImGui::Text("Application avg %.3f", 1000.0f / ImGui::GetIO().Framerate);
 	}
 }
\ No newline at end of file
@@ -4,6 +4,10 @@
 
 #include "Texture.h"
 #include "VertexBufferLayout.h"
+#include "BatchTransform.h"
+#include "Camera.h"
+#include "Culling.h"
+#include "SpatialGrid.h"
 
 namespace test {
 	class TestBatchRendering : public Test
@@ -15,14 +19,75 @@ namespace test {
 		void OnUpdate(float deltaTime) override;
 		void OnRender() override;
 		void OnImGuiRender() override;
+
+		bool IsThreaded() const override { return true; }
+		void OnPublish() override;
 	private:
+		struct Sprite {
+			glm::vec3 position;
+			float rotation, spin;
+			glm::vec2 scale;
+		};
+
+		void DrawSpritesPretransformed(const Renderer& renderer, const TransformArrays& sprites, int count);
+		void DrawSpritesPerDraw(const Renderer& renderer, const TransformArrays& sprites, int count);
+
 		std::unique_ptr<VertexArray> m_VAO;
 		std::unique_ptr<IndexBuffer> m_IndexBuffer;
 		std::unique_ptr<Shader> m_Shader;
 		std::unique_ptr<Texture> m_Texture;
 		std::unique_ptr<VertexBuffer> m_VertexBuffer;
 
-		glm::mat4 m_Proj, m_View;
+		OrthographicCamera m_Camera;
+		CameraBuffer m_CameraBuffer;
+
+		//Simulation state, written by OnUpdate on the update thread
 		glm::vec3 m_Translation;
+		glm::vec3 m_Velocity;
+		bool m_Animate;
+
+		//None by default, so the scene starts as just the original two quads
+		std::vector<Sprite> m_Sprites;
+		int m_SpriteCount;
+		//Spreads the sprites over this many screens in each direction
+		float m_WorldScale;
+
+		//Render state, copied from the simulation in OnPublish. Settings that
+		//ImGui can change after that are latched here too, so OnRender always
+		//sees the ones the sprites and the grid were last brought up to date with
+		glm::vec3 m_RenderTranslation;
+		TransformArrays m_RenderSprites;
+		BoundsArrays m_RenderBounds;
+		int m_RenderSpriteCount;
+		float m_RenderWorldScale;
+		bool m_RenderCullWithGrid;
+
+		//Culled sprites are tested against the camera's rectangle and
+		//the visible ones gathered into their own arrays before drawing
+		bool m_Cull, m_CullInParallel;
+		std::vector<unsigned int> m_Visible;
+		//Or looked up in a grid kept in step with the sprites, so only
+		//those in the cells around the camera are tested
+		bool m_CullWithGrid;
+		SpatialGrid m_Grid;
+		//What the grid was last brought up to date with, -1 when it is out of date
+		float m_GridWorldScale;
+		int m_GridSpriteCount;
+		TransformArrays m_VisibleSprites;
+		int m_VisibleCount;
+		float m_CullMs;
+
+		//Pretransformed sprites are streamed into one buffer and drawn
+		//at once, the others are drawn one by one with their own MVP
+		bool m_Pretransform;
+		std::vector<QuadVertex> m_SpriteVertices;
+		VertexBuffer m_SpriteBuffer;
+		VertexArray m_SpriteVAO;
+		IndexBuffer m_SpriteIndexBuffer;
+		Shader m_BatchShader;
+		VertexBuffer m_UnitQuadBuffer;
+		VertexArray m_UnitQuadVAO;
+		IndexBuffer m_UnitQuadIndexBuffer;
+		float m_SpriteMs;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include "TestBatchTransform.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+#include "JobSystem.h"
+#include "SIMD.h"
+#include "imgui/imgui.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+namespace test {
+
+	static const int MaxObjects = 250000;
+
+	TestBatchTransform::TestBatchTransform()
+		: m_Camera(0.0f, 960.0f, 0.0f, 540.0f), m_ObjectCount(100000), m_Iterations(10)
+	{
+		m_Camera.SetPosition(glm::vec3(100.0f, 0.0f, 0.0f));
+
+		std::mt19937 random(1234);
+		std::uniform_real_distribution<float> x(0.0f, 960.0f), y(0.0f, 540.0f), angle(0.0f, 6.2831853f), scale(4.0f, 24.0f);
+
+		m_Positions.resize(MaxObjects);
+		m_Rotations.resize(MaxObjects);
+		m_Scales.resize(MaxObjects);
+		m_Transforms.Resize(MaxObjects);
+		for (int i = 0; i < MaxObjects; i++)
+		{
+			m_Positions[i] = glm::vec3(x(random), y(random), 0.0f);
+			m_Rotations[i] = angle(random);
+			m_Scales[i] = glm::vec2(scale(random), scale(random));
+			m_Transforms.Set(i, m_Positions[i], m_Rotations[i], m_Scales[i]);
+		}
+	}
+
+	TestBatchTransform::~TestBatchTransform()
+	{
+	}
+
+	//What the tests used to do for every object they draw
+	double TestBatchTransform::RunGLM(int count)
+	{
+		glm::mat4 projection = m_Camera.GetProjection(), view = m_Camera.GetView();
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int iteration = 0; iteration < m_Iterations; iteration++)
+		{
+			for (int i = 0; i < count; i++)
+			{
+				glm::mat4 model = glm::translate(glm::mat4(1.0f), m_Positions[i]);
+				model = glm::rotate(model, m_Rotations[i], glm::vec3(0.0f, 0.0f, 1.0f));
+				model = glm::scale(model, glm::vec3(m_Scales[i], 1.0f));
+				m_Reference[i] = projection * view * model;
+			}
+		}
+		auto end = std::chrono::high_resolution_clock::now();
+		return std::chrono::duration<double, std::milli>(end - start).count() / m_Iterations;
+	}
+
+	double TestBatchTransform::RunBatch(int count, bool parallel)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int iteration = 0; iteration < m_Iterations; iteration++)
+		{
+			const glm::mat4& viewProjection = m_Camera.GetViewProjection();
+			if (parallel)
+			{
+				JobSystem::Get().ParallelFor(count, 4096, [this, &viewProjection](int begin, int end) {
+					BatchTransform::ComputeMVP(m_Transforms, begin, end, viewProjection, m_Output.data());
+				});
+			}
+			else
+			{
+				BatchTransform::ComputeMVP(m_Transforms, 0, count, viewProjection, m_Output.data());
+			}
+		}
+		auto end = std::chrono::high_resolution_clock::now();
+		return std::chrono::duration<double, std::milli>(end - start).count() / m_Iterations;
+	}
+
+	double TestBatchTransform::GetMaxError(int count) const
+	{
+		float error = 0.0f;
+		for (int i = 0; i < count; i++)
+		{
+			for (int column = 0; column < 4; column++)
+			{
+				glm::vec4 difference = glm::abs(m_Output[i][column] - m_Reference[i][column]);
+				error = std::max(error, std::max(std::max(difference.x, difference.y), std::max(difference.z, difference.w)));
+			}
+		}
+		return error;
+	}
+
+	void TestBatchTransform::RunAll()
+	{
+		int count = m_ObjectCount;
+		m_Reference.resize(count);
+		m_Output.resize(count);
+
+		double baseline = RunGLM(count);
+		m_Results.push_back({ "glm", count, baseline, 0.0, 1.0 });
+
+		SIMDLevel previous = SIMD::GetLevel();
+		SIMDLevel supported = SIMD::GetSupportedLevel();
+		for (int level = 0; level <= (int)supported; level++)
+		{
+			SIMD::SetLevel((SIMDLevel)level);
+			double milliseconds = RunBatch(count, false);
+			m_Results.push_back({ SIMD::GetLevelName((SIMDLevel)level), count, milliseconds, GetMaxError(count), baseline / milliseconds });
+		}
+		SIMD::SetLevel(previous);
+
+		double milliseconds = RunBatch(count, true);
+		std::string method = std::string(SIMD::GetLevelName(previous)) + " + jobs";
+		m_Results.push_back({ method, count, milliseconds, GetMaxError(count), baseline / milliseconds });
+	}
+
+	void TestBatchTransform::OnImGuiRender()
+	{
+		ImGui::Text("Supported: %s", SIMD::GetLevelName(SIMD::GetSupportedLevel()));
+		int level = (int)SIMD::GetLevel();
+		if (ImGui::SliderInt("Level", &level, 0, (int)SIMD::GetSupportedLevel(), SIMD::GetLevelName((SIMDLevel)level)))
+			SIMD::SetLevel((SIMDLevel)level);
+
+		ImGui::SliderInt("Objects", &m_ObjectCount, 1000, MaxObjects);
+		ImGui::SliderInt("Iterations", &m_Iterations, 1, 100);
+
+		if (ImGui::Button("Run"))
+			RunAll();
+		ImGui::SameLine();
+		if (ImGui::Button("Clear"))
+			m_Results.clear();
+
+		ImGui::Columns(5);
+		ImGui::Text("Method"); ImGui::NextColumn();
+		ImGui::Text("Objects"); ImGui::NextColumn();
+		ImGui::Text("ms"); ImGui::NextColumn();
+		ImGui::Text("Max error"); ImGui::NextColumn();
+		ImGui::Text("Speedup"); ImGui::NextColumn();
+		for (const Result& result : m_Results)
+		{
+			ImGui::Text("%s", result.method.c_str()); ImGui::NextColumn();
+			ImGui::Text("%d", result.objects); ImGui::NextColumn();
+			ImGui::Text("%.3f", result.milliseconds); ImGui::NextColumn();
+			ImGui::Text("%g", result.maxError); ImGui::NextColumn();
+			ImGui::Text("%.2fx", result.speedup); ImGui::NextColumn();
+		}
+		ImGui::Columns(1);
+	}
+}
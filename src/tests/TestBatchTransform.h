@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Test.h"
+
+#include "BatchTransform.h"
+#include "Camera.h"
+
+namespace test {
+	class TestBatchTransform : public Test
+	{
+	public:
+		TestBatchTransform();
+		~TestBatchTransform();
+
+		void OnImGuiRender() override;
+	private:
+		struct Result {
+			std::string method;
+			int objects;
+			double milliseconds;
+			double maxError;
+			double speedup;
+		};
+
+		double RunGLM(int count);
+		double RunBatch(int count, bool parallel);
+		double GetMaxError(int count) const;
+		void RunAll();
+
+		//The same objects as plain vectors for the glm path and as arrays for BatchTransform
+		std::vector<glm::vec3> m_Positions;
+		std::vector<float> m_Rotations;
+		std::vector<glm::vec2> m_Scales;
+		TransformArrays m_Transforms;
+
+		std::vector<glm::mat4> m_Reference, m_Output;
+		OrthographicCamera m_Camera;
+		std::vector<Result> m_Results;
+
+		int m_ObjectCount;
+		int m_Iterations;
+	};
+}
@@ -0,0 +1,133 @@
+#include "TestCommandBuffers.h"
+
+#include <chrono>
+#include <memory>
+#include <random>
+
+#include "Renderer.h"
+#include "MemoryTracker.h"
+#include "JobSystem.h"
+#include "imgui/imgui.h"
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+
+namespace test {
+
+	static const int MaxObjects = 100000;
+
+	TestCommandBuffers::TestCommandBuffers()
+		: m_Camera(0.0f, 960.0f, 0.0f, 540.0f), m_MVPLocation(-1),
+		m_ObjectCount(10000), m_Parallel(true), m_RecordMs(0.0f), m_SubmitMs(0.0f), m_Allocations(0)
+	{
+		MEMORY_TAG(Meshes);
+
+		float positions[] = {
+			-0.5f, -0.5f, 0.0f, 0.0f,
+			 0.5f, -0.5f, 1.0f, 0.0f,
+			 0.5f,  0.5f, 1.0f, 1.0f,
+			-0.5f,  0.5f, 0.0f, 1.0f
+		};
+
+		unsigned int indicies[] = {
+			0, 1, 2,
+			2, 3, 0
+		};
+
+		GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+		GLCall(glEnable(GL_BLEND));
+
+		m_Shader = std::make_unique<Shader>("res/shaders/Basic.shader");
+		m_VAO = std::make_unique<VertexArray>();
+
+		m_VertexBuffer = std::make_unique<VertexBuffer>(positions, 4 * 4 * sizeof(float));
+
+		VertexBufferLayout layout;
+		layout.Push<float>(2);
+		layout.Push<float>(2);
+		m_VAO->AddBuffer(*m_VertexBuffer, layout);
+
+		m_IndexBuffer = std::make_unique<IndexBuffer>(indicies, 6);
+
+		m_Shader->Bind();
+
+		m_Texture = std::make_unique<Texture>("res/textures/destroyer.png");
+		m_Shader->SetUniform1i("u_Texture", 0);
+
+		//Looked up here since recording threads can't touch GL
+		m_MVPLocation = m_Shader->GetUniformLocation("u_MVP");
+
+		std::mt19937 random(1234);
+		std::uniform_real_distribution<float> x(0.0f, 960.0f), y(0.0f, 540.0f), depth(0.0f, 1.0f), scale(4.0f, 24.0f);
+		m_Transforms.Resize(MaxObjects);
+		m_Depths.resize(MaxObjects);
+		m_MVPs.resize(MaxObjects);
+		for (int i = 0; i < MaxObjects; i++)
+		{
+			float size = scale(random);
+			m_Transforms.Set(i, glm::vec3(x(random), y(random), 0.0f), 0.0f, glm::vec2(size, size));
+			m_Depths[i] = depth(random);
+		}
+	}
+
+	TestCommandBuffers::~TestCommandBuffers()
+	{
+	}
+
+	void TestCommandBuffers::Record(int begin, int end, const glm::mat4& viewProjection)
+	{
+		RenderCommandBuffer& buffer = m_Queue.GetBuffer();
+		unsigned int shader = m_Shader->GetRendererID();
+		unsigned int texture = m_Texture->GetRendererID();
+
+		BatchTransform::ComputeMVP(m_Transforms, begin, end, viewProjection, m_MVPs.data());
+		for (int i = begin; i < end; i++)
+		{
+			//Far objects first so blending layers them correctly
+			buffer.Draw(RenderCommand::MakeSortKey(0, shader, texture, 1.0f - m_Depths[i]), *m_VAO, *m_IndexBuffer, *m_Shader, m_Texture.get());
+			buffer.SetUniformMat4f(m_MVPLocation, m_MVPs[i]);
+		}
+	}
+
+	void TestCommandBuffers::OnRender()
+	{
+		GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
+		GLCall(glClear(GL_COLOR_BUFFER_BIT));
+
+		Renderer renderer;
+
+		AllocationScope allocations;
+		auto start = std::chrono::high_resolution_clock::now();
+		//Read once here, the camera's getters fill its cache and aren't safe to call from the jobs
+		const glm::mat4& viewProjection = m_Camera.GetViewProjection();
+		if (m_Parallel)
+		{
+			JobSystem::Get().ParallelFor(m_ObjectCount, 1024, [this, &viewProjection](int begin, int end) {
+				Record(begin, end, viewProjection);
+			});
+		}
+		else
+		{
+			Record(0, m_ObjectCount, viewProjection);
+		}
+		auto recorded = std::chrono::high_resolution_clock::now();
+
+		m_Queue.Submit(renderer);
+		auto submitted = std::chrono::high_resolution_clock::now();
+
+		m_Allocations = allocations.GetAllocations();
+		m_RecordMs = std::chrono::duration<float, std::milli>(recorded - start).count();
+		m_SubmitMs = std::chrono::duration<float, std::milli>(submitted - recorded).count();
+	}
+
+	void TestCommandBuffers::OnImGuiRender()
+	{
+		ImGui::SliderInt("Objects", &m_ObjectCount, 1, MaxObjects);
+		ImGui::Checkbox("Record in parallel", &m_Parallel);
+		ImGui::Text("%d threads", JobSystem::Get().GetThreadCount());
+		ImGui::Text("Record %.3f ms, sort + submit %.3f ms", m_RecordMs, m_SubmitMs);
+		//Zero once the buffers have grown to fit the object count
+		ImGui::Text("Heap allocations while recording and submitting: %llu", m_Allocations);
+	}
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Test.h"
+
+#include "Texture.h"
+#include "VertexBufferLayout.h"
+#include "RenderCommandBuffer.h"
+#include "BatchTransform.h"
+#include "Camera.h"
+
+namespace test {
+	class TestCommandBuffers : public Test
+	{
+	public:
+		TestCommandBuffers();
+		~TestCommandBuffers();
+
+		void OnRender() override;
+		void OnImGuiRender() override;
+	private:
+		void Record(int begin, int end, const glm::mat4& viewProjection);
+
+		std::unique_ptr<VertexArray> m_VAO;
+		std::unique_ptr<IndexBuffer> m_IndexBuffer;
+		std::unique_ptr<Shader> m_Shader;
+		std::unique_ptr<Texture> m_Texture;
+		std::unique_ptr<VertexBuffer> m_VertexBuffer;
+
+		RenderQueue m_Queue;
+		TransformArrays m_Transforms;
+		std::vector<float> m_Depths;
+		std::vector<glm::mat4> m_MVPs;
+		OrthographicCamera m_Camera;
+		int m_MVPLocation;
+
+		int m_ObjectCount;
+		bool m_Parallel;
+		float m_RecordMs, m_SubmitMs;
+		unsigned long long m_Allocations;
+	};
+}
@@ -0,0 +1,366 @@
+#include "TestImageDecoding.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#include "ImageDecoder.h"
+#include "JobSystem.h"
+#include "imgui/imgui.h"
+
+namespace test {
+
+	//Minimal PNG encoder for the synthetic corpus: Sub filtered RGBA rows
+	//compressed with greedy LZ77 and the fixed Huffman codes, which gives
+	//the decoders real inflate and unfilter work without needing zlib
+	class SyntheticPNGWriter
+	{
+	public:
+		static std::vector<unsigned char> Encode(const unsigned char* pixels, int width, int height)
+		{
+			size_t stride = (size_t)width * 4;
+			std::vector<unsigned char> filtered;
+			filtered.reserve((stride + 1) * height);
+			for (int y = 0; y < height; y++)
+			{
+				const unsigned char* row = pixels + y * stride;
+				filtered.push_back(1);
+				for (size_t x = 0; x < stride; x++)
+					filtered.push_back((unsigned char)(row[x] - (x >= 4 ? row[x - 4] : 0)));
+			}
+
+			std::vector<unsigned char> zlib = { 0x78, 0x01 };
+			Deflate(filtered, zlib);
+			WriteBigEndian(zlib, Adler32(filtered));
+
+			std::vector<unsigned char> png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+			std::vector<unsigned char> header;
+			WriteBigEndian(header, width);
+			WriteBigEndian(header, height);
+			header.insert(header.end(), { 8, 6, 0, 0, 0 });
+			WriteChunk(png, "IHDR", header);
+			WriteChunk(png, "IDAT", zlib);
+			WriteChunk(png, "IEND", {});
+			return png;
+		}
+
+	private:
+		struct BitWriter {
+			std::vector<unsigned char>& out;
+			unsigned int buffer;
+			int count;
+
+			void Write(unsigned int bits, int length)
+			{
+				buffer |= bits << count;
+				count += length;
+				while (count >= 8)
+				{
+					out.push_back(buffer & 0xFF);
+					buffer >>= 8;
+					count -= 8;
+				}
+			}
+
+			//Huffman codes are packed starting from their most significant bit
+			void WriteCode(unsigned int code, int length)
+			{
+				unsigned int reversed = 0;
+				for (int i = 0; i < length; i++)
+					reversed |= ((code >> i) & 1) << (length - 1 - i);
+				Write(reversed, length);
+			}
+
+			void WriteSymbol(int symbol)
+			{
+				if (symbol < 144)      WriteCode(0x30 + symbol, 8);
+				else if (symbol < 256) WriteCode(0x190 + symbol - 144, 9);
+				else if (symbol < 280) WriteCode(symbol - 256, 7);
+				else                   WriteCode(0xC0 + symbol - 280, 8);
+			}
+
+			void Flush()
+			{
+				if (count > 0)
+					out.push_back(buffer & 0xFF);
+				buffer = 0;
+				count = 0;
+			}
+		};
+
+		static void Deflate(const std::vector<unsigned char>& data, std::vector<unsigned char>& out)
+		{
+			static const int lengthBase[] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+			static const int lengthExtra[] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+			static const int distanceBase[] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+			static const int distanceExtra[] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+			const int hashSize = 1 << 15;
+			const int window = 32768;
+
+			BitWriter writer = { out, 0, 0 };
+			writer.Write(1, 1);
+			writer.Write(1, 2);
+
+			std::vector<int> head(hashSize, -1);
+			auto hash = [&data](size_t i) {
+				return ((data[i] << 10) ^ (data[i + 1] << 5) ^ data[i + 2]) & (hashSize - 1);
+			};
+
+			size_t size = data.size();
+			size_t i = 0;
+			while (i < size)
+			{
+				int length = 0;
+				int distance = 0;
+				if (i + 3 <= size)
+				{
+					int h = hash(i);
+					int candidate = head[h];
+					head[h] = (int)i;
+					if (candidate >= 0 && (int)i - candidate <= window)
+					{
+						size_t maxLength = std::min<size_t>(258, size - i);
+						while ((size_t)length < maxLength && data[candidate + length] == data[i + length])
+							length++;
+						distance = (int)i - candidate;
+					}
+				}
+
+				if (length < 3)
+				{
+					writer.WriteSymbol(data[i]);
+					i++;
+					continue;
+				}
+
+				int code = 28;
+				while (lengthBase[code] > length)
+					code--;
+				writer.WriteSymbol(257 + code);
+				writer.Write(length - lengthBase[code], lengthExtra[code]);
+
+				code = 29;
+				while (distanceBase[code] > distance)
+					code--;
+				writer.WriteCode(code, 5);
+				writer.Write(distance - distanceBase[code], distanceExtra[code]);
+
+				for (size_t end = i + length, j = i + 1; j < end && j + 3 <= size; j++)
+					head[hash(j)] = (int)j;
+				i += length;
+			}
+
+			writer.WriteSymbol(256);
+			writer.Flush();
+		}
+
+		static unsigned int Adler32(const std::vector<unsigned char>& data)
+		{
+			unsigned int a = 1, b = 0;
+			for (unsigned char byte : data)
+			{
+				a = (a + byte) % 65521;
+				b = (b + a) % 65521;
+			}
+			return (b << 16) | a;
+		}
+
+		static unsigned int Crc32(const unsigned char* data, size_t size, unsigned int crc)
+		{
+			static unsigned int table[256];
+			static bool initialized = false;
+			if (!initialized)
+			{
+				for (unsigned int n = 0; n < 256; n++)
+				{
+					unsigned int c = n;
+					for (int k = 0; k < 8; k++)
+						c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+					table[n] = c;
+				}
+				initialized = true;
+			}
+
+			for (size_t i = 0; i < size; i++)
+				crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+			return crc;
+		}
+
+		static void WriteBigEndian(std::vector<unsigned char>& out, unsigned int value)
+		{
+			out.insert(out.end(), { (unsigned char)(value >> 24), (unsigned char)(value >> 16), (unsigned char)(value >> 8), (unsigned char)value });
+		}
+
+		static void WriteChunk(std::vector<unsigned char>& out, const char* type, const std::vector<unsigned char>& data)
+		{
+			WriteBigEndian(out, (unsigned int)data.size());
+			size_t start = out.size();
+			out.insert(out.end(), type, type + 4);
+			out.insert(out.end(), data.begin(), data.end());
+			unsigned int crc = Crc32(out.data() + start, out.size() - start, 0xFFFFFFFFu) ^ 0xFFFFFFFFu;
+			WriteBigEndian(out, crc);
+		}
+	};
+
+	TestImageDecoding::TestImageDecoding()
+		: m_Decoder(0), m_Threads(JobSystem::Get().GetThreadCount()), m_Repeats(4)
+	{
+		LoadTextureCorpus();
+		GenerateSyntheticCorpus();
+	}
+
+	TestImageDecoding::~TestImageDecoding()
+	{
+	}
+
+	void TestImageDecoding::LoadTextureCorpus()
+	{
+		//Files are read up front so only decoding is timed
+		std::vector<std::filesystem::path> paths;
+		std::error_code error;
+		for (const auto& entry : std::filesystem::directory_iterator("res/textures", error))
+		{
+			if (entry.is_regular_file())
+				paths.push_back(entry.path());
+		}
+		std::sort(paths.begin(), paths.end());
+
+		for (const auto& path : paths)
+		{
+			std::ifstream stream(path, std::ios::binary);
+			m_TextureCorpus.emplace_back(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+		}
+	}
+
+	void TestImageDecoding::GenerateSyntheticCorpus()
+	{
+		const int count = 32;
+		const int size = 512;
+		std::vector<unsigned char> pixels((size_t)size * size * 4);
+		unsigned int seed = 12345;
+
+		for (int image = 0; image < count; image++)
+		{
+			//Gradients with checkered noise keep the compression ratio
+			//close to typical sprite art instead of trivially compressible
+			for (int y = 0; y < size; y++)
+			{
+				for (int x = 0; x < size; x++)
+				{
+					seed = seed * 1664525u + 1013904223u;
+					unsigned char* pixel = &pixels[((size_t)y * size + x) * 4];
+					pixel[0] = (unsigned char)(x * 255 / size + image);
+					pixel[1] = (unsigned char)(y * 255 / size);
+					pixel[2] = (unsigned char)((((x >> 4) + (y >> 4) + image) & 1) * 160 + (seed >> 28));
+					pixel[3] = (x >> 6) == (y >> 6) ? 128 : 255;
+				}
+			}
+			m_SyntheticCorpus.push_back(SyntheticPNGWriter::Encode(pixels.data(), size, size));
+		}
+	}
+
+	TestImageDecoding::Result TestImageDecoding::Run(const std::vector<std::vector<unsigned char>>& corpus, const char* corpusName, int decoder, int threads)
+	{
+		ImageDecoder& imageDecoder = *ImageDecoder::GetAvailable()[decoder];
+		int total = (int)corpus.size() * m_Repeats;
+		std::atomic<int> next(0);
+		std::atomic<long long> pixels(0);
+
+		auto work = [&]() {
+			long long decoded = 0;
+			for (int i = next++; i < total; i = next++)
+			{
+				const std::vector<unsigned char>& file = corpus[i % corpus.size()];
+				int width, height, channels;
+				unsigned char* image = imageDecoder.Decode(file.data(), file.size(), width, height, channels, 4);
+				if (image)
+				{
+					decoded += (long long)width * height;
+					imageDecoder.Free(image);
+				}
+			}
+			pixels += decoded;
+		};
+
+		//Threads beyond the job system's own just queue behind them
+		auto start = std::chrono::high_resolution_clock::now();
+		JobCounter counter;
+		for (int i = 1; i < threads; i++)
+			JobSystem::Get().Run(work, &counter);
+		work();
+		JobSystem::Get().Wait(counter);
+		auto end = std::chrono::high_resolution_clock::now();
+
+		Result result;
+		result.decoder = imageDecoder.GetName();
+		result.corpus = corpusName;
+		result.threads = threads;
+		result.images = total;
+		result.milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+		result.megapixels = pixels / 1000000.0;
+		return result;
+	}
+
+	void TestImageDecoding::OnImGuiRender()
+	{
+		const std::vector<ImageDecoder*>& decoders = ImageDecoder::GetAvailable();
+		for (int i = 0; i < (int)decoders.size(); i++)
+		{
+			ImGui::RadioButton(decoders[i]->GetName(), &m_Decoder, i);
+			ImGui::SameLine();
+		}
+		ImGui::NewLine();
+
+		ImGui::SliderInt("Threads", &m_Threads, 1, JobSystem::Get().GetThreadCount());
+		ImGui::SliderInt("Repeats", &m_Repeats, 1, 32);
+		ImGui::Text("Corpus: %d texture files, %d synthetic PNGs", (int)m_TextureCorpus.size(), (int)m_SyntheticCorpus.size());
+
+		if (ImGui::Button("Run"))
+		{
+			if (!m_TextureCorpus.empty())
+				m_Results.push_back(Run(m_TextureCorpus, "res/textures", m_Decoder, m_Threads));
+			m_Results.push_back(Run(m_SyntheticCorpus, "synthetic", m_Decoder, m_Threads));
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Run all"))
+		{
+			for (int decoder = 0; decoder < (int)decoders.size(); decoder++)
+			{
+				//Powers of two, then the configured count when it isn't one
+				for (int threads = 1; ; threads = std::min(threads * 2, m_Threads))
+				{
+					if (!m_TextureCorpus.empty())
+						m_Results.push_back(Run(m_TextureCorpus, "res/textures", decoder, threads));
+					m_Results.push_back(Run(m_SyntheticCorpus, "synthetic", decoder, threads));
+					if (threads >= m_Threads)
+						break;
+				}
+			}
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Use for textures"))
+			ImageDecoder::Set(*decoders[m_Decoder]);
+		ImGui::SameLine();
+		if (ImGui::Button("Clear"))
+			m_Results.clear();
+
+		ImGui::Columns(5);
+		ImGui::Text("Decoder"); ImGui::NextColumn();
+		ImGui::Text("Corpus"); ImGui::NextColumn();
+		ImGui::Text("Threads"); ImGui::NextColumn();
+		ImGui::Text("ms"); ImGui::NextColumn();
+		ImGui::Text("MP/s"); ImGui::NextColumn();
+		for (const Result& result : m_Results)
+		{
+			ImGui::Text("%s", result.decoder.c_str()); ImGui::NextColumn();
+			ImGui::Text("%s", result.corpus.c_str()); ImGui::NextColumn();
+			ImGui::Text("%d", result.threads); ImGui::NextColumn();
+			ImGui::Text("%.2f", result.milliseconds); ImGui::NextColumn();
+			ImGui::Text("%.1f", result.megapixels / (result.milliseconds / 1000.0)); ImGui::NextColumn();
+		}
+		ImGui::Columns(1);
+	}
+}
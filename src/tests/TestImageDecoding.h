@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Test.h"
+
+namespace test {
+	class TestImageDecoding : public Test
+	{
+	public:
+		TestImageDecoding();
+		~TestImageDecoding();
+
+		void OnImGuiRender() override;
+	private:
+		struct Result {
+			std::string decoder;
+			std::string corpus;
+			int threads;
+			int images;
+			double milliseconds;
+			double megapixels;
+		};
+
+		void LoadTextureCorpus();
+		void GenerateSyntheticCorpus();
+		Result Run(const std::vector<std::vector<unsigned char>>& corpus, const char* corpusName, int decoder, int threads);
+
+		std::vector<std::vector<unsigned char>> m_TextureCorpus;
+		std::vector<std::vector<unsigned char>> m_SyntheticCorpus;
+		std::vector<Result> m_Results;
+
+		int m_Decoder;
+		int m_Threads;
+		int m_Repeats;
+	};
+}
@@ -0,0 +1,133 @@
+#include "TestJobSystem.h"
+
+#include <chrono>
+#include <cmath>
+
+#include "JobSystem.h"
+#include "imgui/imgui.h"
+
+namespace test {
+
+	TestJobSystem::TestJobSystem()
+		: m_Data(1 << 22), m_SpawnJobs(100000)
+	{
+	}
+
+	TestJobSystem::~TestJobSystem()
+	{
+	}
+
+	//Empty jobs started from the main thread and joined once,
+	//which is the cost of a job when there is no work in it
+	TestJobSystem::Result TestJobSystem::RunSpawn(int jobs)
+	{
+		JobSystem& jobSystem = JobSystem::Get();
+		JobCounter counter;
+
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < jobs; i++)
+		{
+			jobSystem.Run([]() {}, &counter);
+		}
+		jobSystem.Wait(counter);
+		auto end = std::chrono::high_resolution_clock::now();
+
+		double milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+		return { "Spawn + wait", jobs, milliseconds, milliseconds * 1000000.0 / jobs, 0.0 };
+	}
+
+	//One job at a time, each waited on before the next, which
+	//includes waking a worker when nothing else is queued
+	TestJobSystem::Result TestJobSystem::RunRoundTrip(int jobs)
+	{
+		JobSystem& jobSystem = JobSystem::Get();
+
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < jobs; i++)
+		{
+			JobCounter counter;
+			jobSystem.Run([]() {}, &counter);
+			jobSystem.Wait(counter);
+		}
+		auto end = std::chrono::high_resolution_clock::now();
+
+		double milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+		return { "Round trip", jobs, milliseconds, milliseconds * 1000000.0 / jobs, 0.0 };
+	}
+
+	//The same arithmetic over m_Data split into as many jobs as the
+	//parallelism, so the time shows how it scales across cores
+	TestJobSystem::Result TestJobSystem::RunScaling(int parallelism, double baseline)
+	{
+		JobSystem& jobSystem = JobSystem::Get();
+		JobCounter counter;
+		int count = (int)m_Data.size();
+		float* data = m_Data.data();
+
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < parallelism; i++)
+		{
+			int begin = (int)((long long)count * i / parallelism);
+			int end = (int)((long long)count * (i + 1) / parallelism);
+			jobSystem.Run([data, begin, end]() {
+				for (int j = begin; j < end; j++)
+				{
+					float x = (float)j * 0.001f;
+					data[j] = std::sqrt(x) * std::sin(x) + std::cos(x * 0.5f);
+				}
+			}, &counter);
+		}
+		jobSystem.Wait(counter);
+		auto end = std::chrono::high_resolution_clock::now();
+
+		double milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+		return { "Scaling", parallelism, milliseconds, milliseconds * 1000000.0 / count, baseline > 0.0 ? baseline / milliseconds : 1.0 };
+	}
+
+	void TestJobSystem::OnImGuiRender()
+	{
+		int threads = JobSystem::Get().GetThreadCount();
+		ImGui::Text("%d threads (%d workers + main)", threads, threads - 1);
+		ImGui::SliderInt("Spawned jobs", &m_SpawnJobs, 1000, 1000000);
+
+		if (ImGui::Button("Spawn overhead"))
+		{
+			m_Results.push_back(RunSpawn(m_SpawnJobs));
+			m_Results.push_back(RunRoundTrip(m_SpawnJobs / 100));
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Scaling"))
+		{
+			//Per element time for the scaling rows, speedup is against one job
+			double baseline = 0.0;
+			for (int parallelism = 1; parallelism <= threads * 2; parallelism *= 2)
+			{
+				Result result = RunScaling(parallelism, baseline);
+				if (parallelism == 1)
+					baseline = result.milliseconds;
+				m_Results.push_back(result);
+			}
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Clear"))
+			m_Results.clear();
+
+		ImGui::Columns(5);
+		ImGui::Text("Benchmark"); ImGui::NextColumn();
+		ImGui::Text("Jobs"); ImGui::NextColumn();
+		ImGui::Text("ms"); ImGui::NextColumn();
+		ImGui::Text("ns / item"); ImGui::NextColumn();
+		ImGui::Text("Speedup"); ImGui::NextColumn();
+		for (const Result& result : m_Results)
+		{
+			ImGui::Text("%s", result.benchmark.c_str()); ImGui::NextColumn();
+			ImGui::Text("%d", result.jobs); ImGui::NextColumn();
+			ImGui::Text("%.2f", result.milliseconds); ImGui::NextColumn();
+			ImGui::Text("%.1f", result.nanosecondsPerJob); ImGui::NextColumn();
+			if (result.speedup > 0.0)
+				ImGui::Text("%.2fx", result.speedup);
+			ImGui::NextColumn();
+		}
+		ImGui::Columns(1);
+	}
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Test.h"
+
+namespace test {
+	class TestJobSystem : public Test
+	{
+	public:
+		TestJobSystem();
+		~TestJobSystem();
+
+		void OnImGuiRender() override;
+	private:
+		struct Result {
+			std::string benchmark;
+			int jobs;
+			double milliseconds;
+			double nanosecondsPerJob;
+			double speedup;
+		};
+
+		Result RunSpawn(int jobs);
+		Result RunRoundTrip(int jobs);
+		Result RunScaling(int parallelism, double baseline);
+
+		std::vector<float> m_Data;
+		std::vector<Result> m_Results;
+
+		int m_SpawnJobs;
+	};
+}
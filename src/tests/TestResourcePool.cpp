@@ -0,0 +1,146 @@
+#include "TestResourcePool.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "Renderer.h"
+#include "GPUMemory.h"
+#include "GPUDeletionQueue.h"
+#include "imgui/imgui.h"
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+
+namespace test {
+
+	static const int MaxMeshes = 4096;
+	
+	TestResourcePool::Mesh::Mesh(const glm::vec3& position, float size)
+		: position(position)
+	{
+		float half = size * 0.5f;
+		float positions[] = {
+			-half, -half, 0.0f, 0.0f,
+			 half, -half, 1.0f, 0.0f,
+			 half,  half, 1.0f, 1.0f,
+			-half,  half, 0.0f, 1.0f
+		};
+
+		vertexBuffer = VertexBuffer(positions, 4 * 4 * sizeof(float));
+
+		VertexBufferLayout layout;
+		layout.Push<float>(2);
+		layout.Push<float>(2);
+		vertexArray.AddBuffer(vertexBuffer, layout);
+	}
+
+	TestResourcePool::TestResourcePool()
+		: m_Camera(0.0f, 960.0f, 0.0f, 540.0f), m_Random(1234),
+		m_MeshCount(512), m_ChurnPerFrame(32), m_ChurnMs(0.0f), m_ReuseChecks(0), m_ReusePassed(0)
+	{
+		unsigned int indicies[] = {
+			0, 1, 2,
+			2, 3, 0
+		};
+
+		GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+		GLCall(glEnable(GL_BLEND));
+
+		m_IndexBuffer = IndexBuffer(indicies, 6);
+		m_Shader = Shader("res/shaders/Basic.shader");
+		m_Shader.Bind();
+		m_Texture = Texture("res/textures/destroyer.png");
+		m_Shader.SetUniform1i("u_Texture", 0);
+
+		m_Meshes.Reserve(MaxMeshes);
+	}
+
+	TestResourcePool::~TestResourcePool()
+	{
+		m_Meshes.Clear();
+	}
+
+	void TestResourcePool::CreateMesh()
+	{
+		std::uniform_real_distribution<float> x(0.0f, 960.0f), y(0.0f, 540.0f), size(8.0f, 48.0f);
+		glm::vec3 position(x(m_Random), y(m_Random), 0.0f);
+		m_Live.push_back(m_Meshes.Create(position, size(m_Random)));
+	}
+
+	Handle<TestResourcePool::Mesh> TestResourcePool::DestroyOldestMesh()
+	{
+		Handle<Mesh> handle = m_Live.front();
+		m_Live.pop_front();
+		m_Meshes.Destroy(handle);
+		return handle;
+	}
+
+	void TestResourcePool::OnUpdate(float deltaTime)
+	{
+		GPUMemorySite site("Resource Pool");
+
+		auto start = std::chrono::high_resolution_clock::now();
+
+		//Replaces the oldest meshes every frame, their buffers are released
+		//while the GPU may still be drawing them from the previous frame
+		int churn = std::min(m_ChurnPerFrame, (int)m_Live.size());
+		for (int i = 0; i < churn; i++)
+		{
+			Handle<Mesh> destroyed = DestroyOldestMesh();
+			CreateMesh();
+
+			//The new mesh reuses the slot just freed, so only its own handle
+			//may resolve to it and the generation has to reject the old one
+			Handle<Mesh> created = m_Live.back();
+			if (created.Index == destroyed.Index)
+			{
+				m_ReuseChecks++;
+				if (!m_Meshes.Get(destroyed) && m_Meshes.Get(created))
+					m_ReusePassed++;
+			}
+		}
+
+		while ((int)m_Live.size() > m_MeshCount)
+			DestroyOldestMesh();
+		while ((int)m_Live.size() < m_MeshCount)
+			CreateMesh();
+
+		m_ChurnMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	void TestResourcePool::OnRender()
+	{
+		GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
+		GLCall(glClear(GL_COLOR_BUFFER_BIT));
+
+		Renderer renderer;
+
+		m_Texture.Bind();
+		m_Shader.Bind();
+		const glm::mat4& viewProjection = m_Camera.GetViewProjection();
+		for (Handle<Mesh> handle : m_Live)
+		{
+			Mesh* mesh = m_Meshes.Get(handle);
+			glm::mat4 mvp = viewProjection * glm::translate(glm::mat4(1.0f), mesh->position);
+			m_Shader.SetUniformMat4f("u_MVP", mvp);
+			renderer.Draw(mesh->vertexArray, m_IndexBuffer, m_Shader);
+		}
+	}
+
+	void TestResourcePool::OnImGuiRender()
+	{
+		ImGui::SliderInt("Meshes", &m_MeshCount, 1, MaxMeshes);
+		ImGui::SliderInt("Replaced per frame", &m_ChurnPerFrame, 0, 512);
+
+		bool deferred = GPUDeletionQueue::Get().IsDeferred();
+		if (ImGui::Checkbox("Deferred deletion", &deferred))
+			GPUDeletionQueue::Get().SetDeferred(deferred);
+
+		ImGui::Text("%u meshes in %u slots", (unsigned int)m_Meshes.GetCount(), (unsigned int)m_Meshes.GetCapacity());
+		ImGui::Text("Create + destroy %.3f ms", m_ChurnMs);
+		ImGui::Text("GL objects awaiting deletion: %u", (unsigned int)GPUDeletionQueue::Get().GetQueuedCount());
+
+		ImGui::Text("Reused slots with the stale handle rejected: %llu of %llu", (unsigned long long)m_ReusePassed, (unsigned long long)m_ReuseChecks);
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Test.h"
+
+#include "Texture.h"
+#include "VertexBufferLayout.h"
+#include "ResourcePool.h"
+#include "Camera.h"
+
+#include <deque>
+#include <random>
+
+namespace test {
+	class TestResourcePool : public Test
+	{
+	public:
+		TestResourcePool();
+		~TestResourcePool();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+	private:
+		//Each mesh owns its own buffers, held by value in the pool
+		struct Mesh {
+			VertexBuffer vertexBuffer;
+			VertexArray vertexArray;
+			glm::vec3 position;
+
+			Mesh(const glm::vec3& position, float size);
+		};
+
+		void CreateMesh();
+		Handle<Mesh> DestroyOldestMesh();
+
+		ResourcePool<Mesh> m_Meshes;
+		//Live handles oldest first
+		std::deque<Handle<Mesh>> m_Live;
+
+		IndexBuffer m_IndexBuffer;
+		Shader m_Shader;
+		Texture m_Texture;
+		OrthographicCamera m_Camera;
+		std::mt19937 m_Random;
+
+		int m_MeshCount;
+		int m_ChurnPerFrame;
+		float m_ChurnMs;
+		//Replacements that landed in the slot they freed, and how many of
+		//those resolved the new handle but not the destroyed one
+		uint64_t m_ReuseChecks, m_ReusePassed;
+	};
+}
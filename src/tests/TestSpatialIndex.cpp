@@ -0,0 +1,162 @@
+#include "TestSpatialIndex.h"
+
+#include <chrono>
+#include <cmath>
+#include <random>
+
+#include "imgui/imgui.h"
+
+namespace test {
+
+	//One object per this many units squared, and a cell holds a couple of them on average
+	static const float AreaPerObject = 64.0f * 64.0f;
+	static const float CellSize = 128.0f;
+	static const glm::vec2 ScreenSize(960.0f, 540.0f);
+	static const int Counts[] = { 10000, 100000, 1000000 };
+
+	TestSpatialIndex::TestSpatialIndex()
+		: m_WorldSize(0.0f), m_MovingPercent(10), m_Iterations(10), m_Queries(100)
+	{
+	}
+
+	TestSpatialIndex::~TestSpatialIndex()
+	{
+	}
+
+	void TestSpatialIndex::Generate(int count)
+	{
+		m_WorldSize = std::sqrt(count * AreaPerObject);
+
+		std::mt19937 random(1234);
+		std::uniform_real_distribution<float> position(0.0f, m_WorldSize), extent(4.0f, 32.0f), velocity(-200.0f, 200.0f);
+
+		m_Bounds.Resize(count);
+		m_Centers.resize(count);
+		m_HalfExtents.resize(count);
+		m_Velocities.resize(count);
+		for (int i = 0; i < count; i++)
+		{
+			m_Centers[i] = glm::vec2(position(random), position(random));
+			m_HalfExtents[i] = glm::vec2(extent(random), extent(random));
+			m_Velocities[i] = glm::vec2(velocity(random), velocity(random));
+			m_Bounds.Set(i, glm::vec3(m_Centers[i] - m_HalfExtents[i], 0.0f), glm::vec3(m_Centers[i] + m_HalfExtents[i], 0.0f));
+		}
+		m_Results.reserve(count);
+		m_Visible.resize(count);
+
+		m_Grid = std::make_unique<SpatialGrid>(glm::vec2(0.0f), glm::vec2(m_WorldSize), CellSize);
+		m_Grid->Build(m_Bounds, count);
+	}
+
+	void TestSpatialIndex::Run(int count)
+	{
+		Generate(count);
+
+		//Moves a share of the objects a frame's worth, then brings the grid up to date
+		//either by updating just those or by rebuilding it from every object
+		int moving = (int)((long long)count * m_MovingPercent / 100);
+		double rebuildMs = 0.0, updateMs = 0.0;
+		for (int iteration = 0; iteration < m_Iterations; iteration++)
+		{
+			for (int i = 0; i < moving; i++)
+			{
+				m_Centers[i] += m_Velocities[i] * (1.0f / 60.0f);
+				m_Bounds.Set(i, glm::vec3(m_Centers[i] - m_HalfExtents[i], 0.0f), glm::vec3(m_Centers[i] + m_HalfExtents[i], 0.0f));
+			}
+
+			auto start = std::chrono::high_resolution_clock::now();
+			for (int i = 0; i < moving; i++)
+				m_Grid->Update(i, m_Centers[i] - m_HalfExtents[i], m_Centers[i] + m_HalfExtents[i]);
+			auto updated = std::chrono::high_resolution_clock::now();
+			m_Grid->Build(m_Bounds, count);
+			auto rebuilt = std::chrono::high_resolution_clock::now();
+
+			updateMs += std::chrono::duration<double, std::milli>(updated - start).count();
+			rebuildMs += std::chrono::duration<double, std::milli>(rebuilt - updated).count();
+		}
+
+		//Screen sized rectangles for visibility, compared against testing every object
+		std::mt19937 random(5678);
+		std::uniform_real_distribution<float> x(0.0f, std::max(0.0f, m_WorldSize - ScreenSize.x)), y(0.0f, std::max(0.0f, m_WorldSize - ScreenSize.y));
+		std::vector<glm::vec2> corners(m_Queries);
+		for (glm::vec2& corner : corners)
+			corner = glm::vec2(x(random), y(random));
+
+		size_t gridFound = 0, scanFound = 0;
+		auto start = std::chrono::high_resolution_clock::now();
+		for (const glm::vec2& corner : corners)
+		{
+			m_Results.clear();
+			m_Grid->QueryRect(corner, corner + ScreenSize, m_Results);
+			gridFound += m_Results.size();
+		}
+		auto queried = std::chrono::high_resolution_clock::now();
+		for (const glm::vec2& corner : corners)
+			scanFound += Culling::CullRect(m_Bounds, 0, count, corner, corner + ScreenSize, m_Visible.data());
+		auto scanned = std::chrono::high_resolution_clock::now();
+
+		//Picking, a point under the cursor
+		auto pickStart = std::chrono::high_resolution_clock::now();
+		for (const glm::vec2& corner : corners)
+		{
+			m_Results.clear();
+			m_Grid->QueryPoint(corner, m_Results);
+		}
+		auto picked = std::chrono::high_resolution_clock::now();
+
+		Result result;
+		result.objects = count;
+		result.movingPercent = m_MovingPercent;
+		result.rebuildMs = rebuildMs / m_Iterations;
+		result.updateMs = updateMs / m_Iterations;
+		result.rectQueryMs = std::chrono::duration<double, std::milli>(queried - start).count() / m_Queries;
+		result.scanMs = std::chrono::duration<double, std::milli>(scanned - queried).count() / m_Queries;
+		result.pointQueryUs = std::chrono::duration<double, std::micro>(picked - pickStart).count() / m_Queries;
+		result.match = gridFound == scanFound;
+		m_Rows.push_back(result);
+	}
+
+	void TestSpatialIndex::OnImGuiRender()
+	{
+		ImGui::SliderInt("Moving %", &m_MovingPercent, 0, 100);
+		ImGui::SliderInt("Iterations", &m_Iterations, 1, 50);
+		ImGui::SliderInt("Queries", &m_Queries, 1, 1000);
+
+		for (int count : Counts)
+		{
+			if (ImGui::Button((std::to_string(count / 1000) + "k").c_str()))
+				Run(count);
+			ImGui::SameLine();
+		}
+		if (ImGui::Button("All"))
+		{
+			for (int count : Counts)
+				Run(count);
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Clear"))
+			m_Rows.clear();
+
+		ImGui::Columns(8);
+		ImGui::Text("Objects"); ImGui::NextColumn();
+		ImGui::Text("Moving"); ImGui::NextColumn();
+		ImGui::Text("Rebuild ms"); ImGui::NextColumn();
+		ImGui::Text("Update ms"); ImGui::NextColumn();
+		ImGui::Text("Rect query ms"); ImGui::NextColumn();
+		ImGui::Text("Scan ms"); ImGui::NextColumn();
+		ImGui::Text("Point query us"); ImGui::NextColumn();
+		ImGui::Text("Match"); ImGui::NextColumn();
+		for (const Result& result : m_Rows)
+		{
+			ImGui::Text("%d", result.objects); ImGui::NextColumn();
+			ImGui::Text("%d%%", result.movingPercent); ImGui::NextColumn();
+			ImGui::Text("%.3f", result.rebuildMs); ImGui::NextColumn();
+			ImGui::Text("%.3f", result.updateMs); ImGui::NextColumn();
+			ImGui::Text("%.3f", result.rectQueryMs); ImGui::NextColumn();
+			ImGui::Text("%.3f", result.scanMs); ImGui::NextColumn();
+			ImGui::Text("%.2f", result.pointQueryUs); ImGui::NextColumn();
+			ImGui::Text("%s", result.match ? "yes" : "no"); ImGui::NextColumn();
+		}
+		ImGui::Columns(1);
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Test.h"
+
+#include "Culling.h"
+#include "SpatialGrid.h"
+
+#include <memory>
+
+namespace test {
+	class TestSpatialIndex : public Test
+	{
+	public:
+		TestSpatialIndex();
+		~TestSpatialIndex();
+
+		void OnImGuiRender() override;
+	private:
+		struct Result {
+			int objects;
+			int movingPercent;
+			double rebuildMs;
+			double updateMs;
+			double rectQueryMs;
+			double scanMs;
+			double pointQueryUs;
+			bool match;
+		};
+
+		void Generate(int count);
+		void Run(int count);
+
+		//Objects are spread at a fixed density, so the world grows with their count
+		std::unique_ptr<SpatialGrid> m_Grid;
+		BoundsArrays m_Bounds;
+		std::vector<glm::vec2> m_Centers, m_HalfExtents, m_Velocities;
+		std::vector<unsigned int> m_Results, m_Visible;
+		float m_WorldSize;
+		std::vector<Result> m_Rows;
+
+		int m_MovingPercent;
+		int m_Iterations;
+		int m_Queries;
+	};
+}
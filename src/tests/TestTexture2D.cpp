@@ -1,7 +1,5 @@
 #include "TestTexture2D.h"
 
-#include <memory>
-
 #include "Renderer.h"
 #include "imgui/imgui.h"
 
@@ -12,9 +10,8 @@
 namespace test {
 
 	TestTexture2D::TestTexture2D()
-		: m_TranslationA(200, 200, 0), m_TranslationB(400, 200, 0),
-		m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f)),
-		m_View(glm::translate(glm::mat4(1.0f), glm::vec3(0, 0, 0)))
+		: m_Camera(0.0f, 960.0f, 0.0f, 540.0f),
+		m_TranslationA(200, 200, 0), m_TranslationB(400, 200, 0)
 	{
 		float positions[] = {
 			-50.0f, -50.0f, 0.0f, 0.0f,
@@ -31,23 +28,21 @@ namespace test {
 		GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
 		GLCall(glEnable(GL_BLEND));
 
-		m_Shader = std::make_unique<Shader>("res/shaders/Basic.shader");
-		m_VAO = std::make_unique<VertexArray>();
-
-		m_VertexBuffer = std::make_unique<VertexBuffer>(positions, 4 * 4 * sizeof(float));
+		m_Shader = Shader("res/shaders/Basic.shader");
+		m_VertexBuffer = VertexBuffer(positions, 4 * 4 * sizeof(float));
 
 		VertexBufferLayout layout;
 		layout.Push<float>(2);
 		layout.Push<float>(2);
-		m_VAO->AddBuffer(*m_VertexBuffer, layout);
+		m_VAO.AddBuffer(m_VertexBuffer, layout);
 
-		m_IndexBuffer = std::make_unique<IndexBuffer>(indicies, 6);
+		m_IndexBuffer = IndexBuffer(indicies, 6);
 
-		m_Shader->Bind();
+		m_Shader.Bind();
 
 
-		m_Texture = std::make_unique<Texture>("res/textures/destroyer.png");
-		m_Shader->SetUniform1i("u_Texture", 0);
+		m_Texture = Texture("res/textures/destroyer.png");
+		m_Shader.SetUniform1i("u_Texture", 0);
 	}
 
 	TestTexture2D::~TestTexture2D()
@@ -66,27 +61,27 @@ namespace test {
 
 		Renderer renderer;
 
-		m_Texture->Bind();
+		m_Texture.Bind();
 
 		//What is entailed in a draw call
 		{
 			glm::mat4 model = glm::translate(glm::mat4(1.0f), m_TranslationA);
-			glm::mat4 mvp = m_Proj * m_View * model;
-			m_Shader->Bind();
-			m_Shader->SetUniformMat4f("u_MVP", mvp);
+			glm::mat4 mvp = m_Camera.GetViewProjection() * model;
+			m_Shader.Bind();
+			m_Shader.SetUniformMat4f("u_MVP", mvp);
 
-			renderer.Draw(*m_VAO, *m_IndexBuffer, *m_Shader);
+			renderer.Draw(m_VAO, m_IndexBuffer, m_Shader);
 		}
 
 
 		//What is entailed in a draw call
 		{
 			glm::mat4 model = glm::translate(glm::mat4(1.0f), m_TranslationB);
-			glm::mat4 mvp = m_Proj * m_View * model;
-			m_Shader->Bind();
-			m_Shader->SetUniformMat4f("u_MVP", mvp);
+			glm::mat4 mvp = m_Camera.GetViewProjection() * model;
+			m_Shader.Bind();
+			m_Shader.SetUniformMat4f("u_MVP", mvp);
 
-			renderer.Draw(*m_VAO, *m_IndexBuffer, *m_Shader);
+			renderer.Draw(m_VAO, m_IndexBuffer, m_Shader);
 		}
 	}
 
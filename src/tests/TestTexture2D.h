@@ -4,6 +4,7 @@
 
 #include "Texture.h"
 #include "VertexBufferLayout.h"
+#include "Camera.h"
 
 namespace test {
 	class TestTexture2D : public Test
@@ -16,13 +17,13 @@ namespace test {
 		void OnRender() override;
 		void OnImGuiRender() override;
 	private:
-		std::unique_ptr<VertexArray> m_VAO;
-		std::unique_ptr<IndexBuffer> m_IndexBuffer;
-		std::unique_ptr<Shader> m_Shader;
-		std::unique_ptr<Texture> m_Texture;
-		std::unique_ptr<VertexBuffer> m_VertexBuffer;
+		VertexArray m_VAO;
+		IndexBuffer m_IndexBuffer;
+		Shader m_Shader;
+		Texture m_Texture;
+		VertexBuffer m_VertexBuffer;
 
-		glm::mat4 m_Proj, m_View;
+		OrthographicCamera m_Camera;
 		glm::vec3 m_TranslationA, m_TranslationB;
 	};
 }
\ No newline at end of file